@@ -0,0 +1,167 @@
+/**
+ * @file bench_main.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief programa de medição de desempenho: escolhe uma das medições de "benchmark_jc.c", lê os parâmetros
+ * da linha de comandos e escreve o CSV no stdout. Compilar (ver README):
+ * gcc -std=gnu11 -O2 -o bench bench_main.c [todos os *_jc.c exceto tests_jc.c, e hash_known_algorithms.c] -lm -lpthread
+ * @version 0.1
+ * @date 2021-06-10
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "benchmark_jc.h"
+
+// uso interno, não exportar!!!!!
+void benchUsage(const char *prog)
+{
+    fprintf(stderr,
+            "uso: %s <medição> [parâmetros]\n"
+            "  hash <corpus>                              débito das funções de hash por comprimento das chaves\n"
+            "  dist <corpus> <M> [M...]                   distribuição das chaves para cada dimensão da tabela\n"
+            "  mt [chaves] [threads] [ops] [%%escritas]    escalabilidade da hashtable concorrente\n"
+            "  slab [chaves] [nodos por bloco]            construção/destruição com e sem slab\n"
+            "  batch [chaves] [pesquisas]                 pesquisas uma a uma e em lote\n"
+            "  inline <corpus> [rondas]                   chaves guardadas no nodo e em ponteiro\n"
+            "  sizing <corpus> [rondas]                   dimensões primas e potências de 2\n"
+            "  parallel <corpus> [threads] [rondas]       construção em série e em paralelo\n"
+            "  autohash <corpus> [amostra]                escolha automática da função de hash\n"
+            "  wordcount <ficheiro>                       contagem de palavras\n"
+            "o corpus tem uma chave por linha; os parâmetros entre [] têm valores por omissão\n",
+            prog);
+}
+
+/**
+ * @brief função que converte o argumento "i" num inteiro positivo ou devolve "omissao" se o argumento
+ * não existir; termina o programa se o argumento não for um número válido (NOTA: é uma função interna)
+ *
+ * @param argc
+ * @param argv
+ * @param i
+ * @param omissao
+ * @return size_t
+ */
+size_t benchArgSize(int argc, char **argv, int i, size_t omissao)
+{
+    if (i >= argc)
+        return omissao;
+    char *fim;
+    errno = 0;
+    unsigned long long v = strtoull(argv[i], &fim, 10);
+    if (errno || fim == argv[i] || *fim != '\0' || v == 0 || argv[i][0] == '-')
+    {
+        fprintf(stderr, "parâmetro inválido: %s\n", argv[i]);
+        exit(EXIT_FAILURE);
+    }
+    return (size_t)v;
+}
+
+// uso interno, não exportar!!!!!
+int benchArgInt(int argc, char **argv, int i, int omissao, int maximo)
+{
+    size_t v = benchArgSize(argc, argv, i, (size_t)omissao);
+    if (v > (size_t)maximo)
+    {
+        fprintf(stderr, "parâmetro inválido: %s (máximo %d)\n", argv[i], maximo);
+        exit(EXIT_FAILURE);
+    }
+    return (int)v;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        benchUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *teste = argv[1];
+
+    // medições sem corpus
+    if (strcmp(teste, "mt") == 0)
+    {
+        benchHashTableMTScaling(stdout, benchArgSize(argc, argv, 2, 1 << 20), benchArgInt(argc, argv, 3, 8, 1024),
+                                benchArgSize(argc, argv, 4, 1 << 20), benchArgInt(argc, argv, 5, 10, 100));
+        return EXIT_SUCCESS;
+    }
+    if (strcmp(teste, "slab") == 0)
+    {
+        benchHashTableSlab(stdout, benchArgSize(argc, argv, 2, 1 << 20), benchArgSize(argc, argv, 3, 1024));
+        return EXIT_SUCCESS;
+    }
+    if (strcmp(teste, "batch") == 0)
+    {
+        benchHashTableBatch(stdout, benchArgSize(argc, argv, 2, 1 << 22), benchArgSize(argc, argv, 3, 1 << 22));
+        return EXIT_SUCCESS;
+    }
+
+    // medições sobre um ficheiro
+    if (argc < 3)
+    {
+        benchUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (strcmp(teste, "wordcount") == 0)
+    {
+        if (!benchWordCount(stdout, argv[2]))
+        {
+            fprintf(stderr, "não foi possível ler %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    size_t nkeys;
+    char **keys = benchLoadKeys(argv[2], &nkeys);
+    if (!keys || nkeys == 0)
+    {
+        fprintf(stderr, "corpus vazio ou não foi possível ler %s\n", argv[2]);
+        benchFreeKeys(keys, nkeys);
+        return EXIT_FAILURE;
+    }
+    int r = EXIT_SUCCESS;
+    if (strcmp(teste, "hash") == 0)
+    {
+        benchHashThroughput(stdout, keys, nkeys);
+    }
+    else if (strcmp(teste, "dist") == 0 && argc > 3)
+    {
+        size_t nsizes = (size_t)(argc - 3);
+        size_t *sizes = (size_t *)malloc(nsizes * sizeof(size_t));
+        for (size_t i = 0; sizes && i < nsizes; i++)
+        {
+            sizes[i] = benchArgSize(argc, argv, (int)i + 3, 0);
+        }
+        if (sizes)
+            benchHashDistribution(stdout, keys, nkeys, sizes, nsizes);
+        free(sizes);
+    }
+    else if (strcmp(teste, "inline") == 0)
+    {
+        benchHashTableInlineKeys(stdout, keys, nkeys, benchArgInt(argc, argv, 3, 5, 1 << 20));
+    }
+    else if (strcmp(teste, "sizing") == 0)
+    {
+        benchHashTableSizing(stdout, keys, nkeys, benchArgInt(argc, argv, 3, 5, 1 << 20));
+    }
+    else if (strcmp(teste, "parallel") == 0)
+    {
+        benchHashTableParallelBuild(stdout, keys, nkeys, benchArgInt(argc, argv, 3, 8, 1024), benchArgInt(argc, argv, 4, 3, 1 << 20));
+    }
+    else if (strcmp(teste, "autohash") == 0)
+    {
+        benchHashTableAutoHash(stdout, keys, nkeys, benchArgSize(argc, argv, 3, 1024));
+    }
+    else
+    {
+        benchUsage(argv[0]);
+        r = EXIT_FAILURE;
+    }
+    benchFreeKeys(keys, nkeys);
+    return r;
+}
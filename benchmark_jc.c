@@ -0,0 +1,783 @@
+/**
+ * @file benchmark_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief funções de medição de desempenho das estruturas, os resultados são escritos em CSV
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include <pthread.h>
+#include "benchmark_jc.h"
+#include "hashtable_jc.h"
+#include "hashtable_mt_jc.h"
+#include "hash_known_algorithms.h"
+#include "wordcount_jc.h"
+
+/**
+ * @brief função que devolve o tempo atual em segundos (relógio monotónico)
+ *
+ * @return double
+ */
+double benchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief função para ler um corpus de chaves, uma chave por linha (as linhas vazias são ignoradas)
+ *
+ * @param path
+ * @param nkeys devolve o número de chaves lidas
+ * @return char** array de strings (libertar com benchFreeKeys) ou NULL se não conseguir abrir o ficheiro
+ */
+char **benchLoadKeys(const char *path, size_t *nkeys)
+{
+    FILE *f = fopen(path, "r");
+    (*nkeys) = 0;
+    if (!f)
+        return NULL;
+    size_t cap = 1024;
+    char **keys = (char **)malloc(cap * sizeof(char *));
+    assert(keys);
+    char *linha = NULL;
+    size_t n = 0;
+    ssize_t l;
+    while ((l = getline(&linha, &n, f)) > 0)
+    {
+        while (l > 0 && (linha[l - 1] == '\n' || linha[l - 1] == '\r'))
+            linha[--l] = '\0';
+        if (l == 0)
+            continue;
+        if ((*nkeys) == cap)
+        {
+            cap *= 2;
+            keys = (char **)realloc(keys, cap * sizeof(char *));
+            assert(keys);
+        }
+        keys[(*nkeys)++] = strdup(linha);
+    }
+    free(linha);
+    fclose(f);
+    return keys;
+}
+
+/**
+ * @brief função para libertar o corpus lido com benchLoadKeys
+ *
+ * @param keys
+ * @param nkeys
+ * @return char** NULL
+ */
+char **benchFreeKeys(char **keys, size_t nkeys)
+{
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        free(keys[i]);
+    }
+    free(keys);
+    return NULL;
+}
+
+// uso interno, não exportar!!!!!
+char *benchGetString(void *data)
+{
+    return (char *)data;
+}
+
+/**
+ * @brief gerador pseudo-aleatório xorshift64 (NOTA: é uma função interna)
+ *
+ * @param s estado, nunca pode ser zero
+ * @return unsigned long long
+ */
+unsigned long long benchRand(unsigned long long *s)
+{
+    unsigned long long x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (*s) = x;
+}
+
+// uso interno, não exportar!!!!!
+const void *benchGetKeyU64(void *data, unsigned int *length)
+{
+    (*length) = (unsigned int)sizeof(unsigned long long);
+    return data;
+}
+
+/**
+ * @brief contexto de cada thread do teste de escalabilidade da tabela partilhável
+ */
+typedef struct benchmtctx BenchMTCtx;
+struct benchmtctx {
+    HashTableMTCFG *ht;
+    unsigned long long *keys;
+    size_t nkeys;
+    size_t ops;
+    int updatePercent;
+    unsigned long long seed;
+};
+
+// uso interno, não exportar!!!!!
+void *benchHashTableMTWorker(void *arg)
+{
+    BenchMTCtx *ctx = (BenchMTCtx *)arg;
+    unsigned long long s = ctx->seed;
+    for (size_t i = 0; i < ctx->ops; i++)
+    {
+        unsigned long long r = benchRand(&s);
+        unsigned long long *k = &ctx->keys[(r >> 8) % ctx->nkeys];
+        if ((int)(r % 100) < ctx->updatePercent)
+        {
+            if (r & 128)
+                htmtInsertData(ctx->ht, k);
+            else
+                htmtRemoveKey(ctx->ht, k, (unsigned int)sizeof(*k));
+        }
+        else
+        {
+            htmtExistKey(ctx->ht, k, (unsigned int)sizeof(*k));
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief procedimento para medir a escalabilidade da tabela partilhável ("hashtable_mt_jc") de 1 até "maxThreads" threads.
+ * A tabela começa com metade das chaves possíveis, cada thread faz "opsPerThread" operações em que
+ * "updatePercent"% são inserções/remoções (metade de cada) e as restantes pesquisas.
+ * A primeira linha mede a hashtable sem trincos ("hashtable_jc") com a mesma carga, numa só thread.
+ * CSV: engine,threads,ops,seconds,mops,speedup
+ *
+ * @param out
+ * @param nkeys número de chaves possíveis
+ * @param maxThreads
+ * @param opsPerThread
+ * @param updatePercent
+ */
+void benchHashTableMTScaling(FILE *out, size_t nkeys, int maxThreads, size_t opsPerThread, int updatePercent)
+{
+    assert(out && nkeys > 0 && maxThreads > 0);
+    unsigned long long *keys = (unsigned long long *)malloc(nkeys * sizeof(unsigned long long));
+    assert(keys);
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        keys[i] = (unsigned long long)i * 0x9E3779B97F4A7C15ULL;
+    }
+    fprintf(out, "engine,threads,ops,seconds,mops,speedup\n");
+
+    // referência: a hashtable sem sincronização numa só thread
+    HashTableCFG *st = newHashTableKey(nkeys, DJBHash, fakeHashDestroy, benchGetKeyU64, NULL);
+    for (size_t i = 0; i < nkeys; i += 2)
+    {
+        htInsertData(st, &keys[i]);
+    }
+    unsigned long long s = 0x2545F4914F6CDD1DULL;
+    double t0 = benchNow();
+    for (size_t i = 0; i < opsPerThread; i++)
+    {
+        unsigned long long r = benchRand(&s);
+        unsigned long long *k = &keys[(r >> 8) % nkeys];
+        if ((int)(r % 100) < updatePercent)
+        {
+            if (r & 128)
+                htInsertData(st, k);
+            else
+                htRemoveKey(st, k, (unsigned int)sizeof(*k));
+        }
+        else
+        {
+            htExistKey(st, k, (unsigned int)sizeof(*k));
+        }
+    }
+    double t = benchNow() - t0;
+    fprintf(out, "ht,1,%zu,%.6f,%.3f,%.3f\n", opsPerThread, t, (double)opsPerThread / t / 1e6, 1.0);
+    destroyHashTable(st);
+
+    double base = 0;
+    BenchMTCtx *ctx = (BenchMTCtx *)malloc((size_t)maxThreads * sizeof(BenchMTCtx));
+    pthread_t *th = (pthread_t *)malloc((size_t)maxThreads * sizeof(pthread_t));
+    assert(ctx && th);
+    for (int n = 1; n <= maxThreads; n++)
+    {
+        HashTableMTCFG *ht = newHashTableMTKey(nkeys, DJBHash, fakeHashDestroy, benchGetKeyU64, NULL);
+        for (size_t i = 0; i < nkeys; i += 2)
+        {
+            htmtInsertData(ht, &keys[i]);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            ctx[i].ht = ht;
+            ctx[i].keys = keys;
+            ctx[i].nkeys = nkeys;
+            ctx[i].ops = opsPerThread;
+            ctx[i].updatePercent = updatePercent;
+            ctx[i].seed = 0x2545F4914F6CDD1DULL + (unsigned long long)i * 0x9E3779B97F4A7C15ULL;
+        }
+        t0 = benchNow();
+        for (int i = 0; i < n; i++)
+        {
+            pthread_create(&th[i], NULL, benchHashTableMTWorker, &ctx[i]);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            pthread_join(th[i], NULL);
+        }
+        t = benchNow() - t0;
+        double mops = (double)n * (double)opsPerThread / t / 1e6;
+        if (n == 1)
+            base = mops;
+        fprintf(out, "htmt,%d,%zu,%.6f,%.3f,%.3f\n", n, (size_t)n * opsPerThread, t, mops, mops / base);
+        destroyHashTableMT(ht);
+    }
+    free(th);
+    free(ctx);
+    free(keys);
+}
+
+/**
+ * @brief procedimento para comparar a construção e destruição de uma hashtable com "nkeys" chaves
+ * com nodos reservados um a um (malloc) e com o alocador "slab" (htSetSlabAllocator).
+ * A memória é medida com "mallinfo2" (memória em uso no heap e em blocos "mmap" antes/depois da construção).
+ * CSV: allocator,nodes,build_s,destroy_s,heap_bytes,heap_bytes_per_key
+ *
+ * @param out
+ * @param nkeys
+ * @param nodesPerBlock
+ */
+void benchHashTableSlab(FILE *out, size_t nkeys, size_t nodesPerBlock)
+{
+    assert(out && nkeys > 0);
+    unsigned long long *keys = (unsigned long long *)malloc(nkeys * sizeof(unsigned long long));
+    assert(keys);
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        keys[i] = (unsigned long long)i * 0x9E3779B97F4A7C15ULL;
+    }
+    fprintf(out, "allocator,nodes,build_s,destroy_s,heap_bytes,heap_bytes_per_key\n");
+    for (int slab = 0; slab <= 1; slab++)
+    {
+        struct mallinfo2 mi = mallinfo2();
+        size_t antes = mi.uordblks + mi.hblkhd;
+        double t0 = benchNow();
+        HashTableCFG *ht = newHashTableKey(nkeys, DJBHash, fakeHashDestroy, benchGetKeyU64, NULL);
+        if (slab)
+            htSetSlabAllocator(ht, nodesPerBlock);
+        for (size_t i = 0; i < nkeys; i++)
+        {
+            htInsertData(ht, &keys[i]);
+        }
+        double tBuild = benchNow() - t0;
+        mi = mallinfo2();
+        size_t bytes = mi.uordblks + mi.hblkhd - antes;
+        t0 = benchNow();
+        destroyHashTable(ht);
+        double tDestroy = benchNow() - t0;
+        fprintf(out, "%s,%zu,%.6f,%.6f,%zu,%.2f\n", slab ? "slab" : "malloc", nkeys, tBuild, tDestroy, bytes, (double)bytes / (double)nkeys);
+    }
+    free(keys);
+}
+
+/**
+ * @brief classes de comprimento das chaves usadas em benchHashThroughput: [1..8], [9..16], [17..32], [33..64], [65..]
+ */
+static const unsigned int benchLengthClasses[] = {8, 16, 32, 64, 0xFFFFFFFFU};
+static const char *benchLengthClassNames[] = {"1-8", "9-16", "17-32", "33-64", "65+"};
+#define BENCH_LENGTH_CLASSES 5
+
+/**
+ * @brief procedimento para medir a velocidade de cada função de "hash_known_algorithms.c" sobre o corpus,
+ * separada por classe de comprimento das chaves (cada classe é repetida até somar pelo menos 64MB).
+ * CSV: hash,length_class,keys,bytes,seconds,gbps,ns_per_key
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ */
+void benchHashThroughput(FILE *out, char **keys, size_t nkeys)
+{
+    assert(out && keys);
+    unsigned int *lens = (unsigned int *)malloc(nkeys * sizeof(unsigned int));
+    size_t *ordem = (size_t *)malloc(nkeys * sizeof(size_t));
+    assert(lens && ordem);
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        lens[i] = (unsigned int)strlen(keys[i]);
+    }
+    fprintf(out, "hash,length_class,keys,bytes,seconds,gbps,ns_per_key\n");
+    volatile unsigned int sink = 0;
+    unsigned int minimo = 0;
+    for (int c = 0; c < BENCH_LENGTH_CLASSES; c++)
+    {
+        // chaves desta classe de comprimento
+        size_t n = 0;
+        unsigned long long bytes = 0;
+        for (size_t i = 0; i < nkeys; i++)
+        {
+            if (lens[i] > minimo && lens[i] <= benchLengthClasses[c])
+            {
+                ordem[n++] = i;
+                bytes += lens[i];
+            }
+        }
+        minimo = benchLengthClasses[c];
+        if (n == 0)
+            continue;
+        int rondas = (int)((64ULL << 20) / bytes) + 1;
+        for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+        {
+            TfuncHashKnownAlgorithm fh = hashKnownAlgorithms[f].func;
+            unsigned int acc = 0;
+            double t0 = benchNow();
+            for (int r = 0; r < rondas; r++)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    acc += fh(keys[ordem[i]], lens[ordem[i]]);
+                }
+            }
+            double t = benchNow() - t0;
+            sink += acc;
+            double total = (double)bytes * rondas;
+            fprintf(out, "%s,%s,%zu,%.0f,%.6f,%.3f,%.2f\n", hashKnownAlgorithms[f].name, benchLengthClassNames[c], n, total, t,
+                    total / t / 1e9, t * 1e9 / ((double)n * rondas));
+        }
+    }
+    (void)sink;
+    free(ordem);
+    free(lens);
+}
+
+/**
+ * @brief procedimento para medir a distribuição das chaves distintas do corpus por exatamente M linhas
+ * (linha = hash % M, a redução das tabelas com M primo) para cada função de "hash_known_algorithms.c" e cada
+ * dimensão pedida; as dimensões não são arredondadas para primo, para medir também as potências de 2, onde
+ * as funções mais fracas falham. O qui-quadrado compara o número de chaves por linha com a distribuição
+ * uniforme (chi2_norm = chi2 / (M - 1), próximo de 1 para uma boa função); "seconds" é o tempo de calcular
+ * e contar os hashes.
+ * CSV: hash,M,keys,load_factor,max_chain,min_chain,empty_rows,chi2,chi2_norm,seconds
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ * @param tableSizes
+ * @param nsizes
+ */
+void benchHashDistribution(FILE *out, char **keys, size_t nkeys, const size_t *tableSizes, size_t nsizes)
+{
+    assert(out && keys && tableSizes);
+    // as chaves repetidas do corpus só contam uma vez, como numa tabela
+    HashTableCFG *ht = newHashTableHashKey(nkeys + 1, WYHash, fakeHashDestroy, benchGetString);
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        htInsertData(ht, keys[i]);
+    }
+    htRehashAll(ht);
+    size_t n = 0;
+    char **distintas = (char **)malloc((ht->totalItems + 1) * sizeof(char *));
+    unsigned int *lens = (unsigned int *)malloc((ht->totalItems + 1) * sizeof(unsigned int));
+    assert(distintas && lens);
+    for (size_t i = 0; i < ht->M; i++)
+    {
+        for (NodoHashTable *nodo = ht->hashtable[i]; nodo; nodo = nodo->next)
+        {
+            distintas[n] = (char *)nodo->data;
+            lens[n++] = nodo->length;
+        }
+    }
+    destroyHashTable(ht);
+
+    fprintf(out, "hash,M,keys,load_factor,max_chain,min_chain,empty_rows,chi2,chi2_norm,seconds\n");
+    for (size_t s = 0; s < nsizes; s++)
+    {
+        size_t m = tableSizes[s];
+        size_t *counts = (size_t *)malloc(m * sizeof(size_t));
+        assert(m > 0 && counts);
+        for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+        {
+            memset(counts, 0, m * sizeof(size_t));
+            double t0 = benchNow();
+            for (size_t i = 0; i < n; i++)
+            {
+                counts[(size_t)hashKnownAlgorithms[f].func(distintas[i], lens[i]) % m]++;
+            }
+            double t = benchNow() - t0;
+            double esperado = (double)n / (double)m;
+            double chi2 = 0;
+            size_t maior = 0, menor = n, vazias = 0;
+            for (size_t i = 0; i < m; i++)
+            {
+                double l = (double)counts[i];
+                chi2 += (l - esperado) * (l - esperado) / esperado;
+                maior = counts[i] > maior ? counts[i] : maior;
+                menor = counts[i] < menor ? counts[i] : menor;
+                vazias += counts[i] == 0 ? 1 : 0;
+            }
+            fprintf(out, "%s,%zu,%zu,%.4f,%zu,%zu,%zu,%.2f,%.4f,%.6f\n", hashKnownAlgorithms[f].name, m, n, esperado,
+                    maior, menor, vazias, chi2, m > 1 ? chi2 / (double)(m - 1) : 0, t);
+        }
+        free(counts);
+    }
+    free(distintas);
+    free(lens);
+}
+
+/**
+ * @brief procedimento para comparar as pesquisas uma a uma (htExistKey) com as pesquisas em lote (htExistKeyBatch)
+ * numa hashtable com "nkeys" chaves inteiras (deve ser maior do que a cache L3 para medir as faltas de cache).
+ * As "nlookups" chaves pesquisadas são aleatórias, metade existe na tabela.
+ * CSV: mode,keys,lookups,found,seconds,mlookups
+ *
+ * @param out
+ * @param nkeys
+ * @param nlookups
+ */
+void benchHashTableBatch(FILE *out, size_t nkeys, size_t nlookups)
+{
+    assert(out && nkeys > 0 && nlookups > 0);
+    unsigned long long *keys = (unsigned long long *)malloc(nkeys * sizeof(unsigned long long));
+    unsigned long long *procurar = (unsigned long long *)malloc(nlookups * sizeof(unsigned long long));
+    const void **ptrs = (const void **)malloc(nlookups * sizeof(void *));
+    unsigned int *lengths = (unsigned int *)malloc(nlookups * sizeof(unsigned int));
+    void **results = (void **)malloc(nlookups * sizeof(void *));
+    assert(keys && procurar && ptrs && lengths && results);
+    HashTableCFG *ht = newHashTableKey(nkeys, WYHash, fakeHashDestroy, benchGetKeyU64, NULL);
+    htSetSlabAllocator(ht, 4096);
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        keys[i] = (unsigned long long)i * 0x9E3779B97F4A7C15ULL;
+        htInsertData(ht, &keys[i]);
+    }
+    unsigned long long s = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < nlookups; i++)
+    {
+        unsigned long long r = benchRand(&s);
+        // metade das chaves existe (índice < nkeys), a outra metade não
+        procurar[i] = (r % (2ULL * nkeys)) * 0x9E3779B97F4A7C15ULL;
+        ptrs[i] = &procurar[i];
+        lengths[i] = (unsigned int)sizeof(unsigned long long);
+    }
+    fprintf(out, "mode,keys,lookups,found,seconds,mlookups\n");
+    size_t found = 0;
+    double t0 = benchNow();
+    for (size_t i = 0; i < nlookups; i++)
+    {
+        found += htExistKey(ht, ptrs[i], lengths[i]) ? 1 : 0;
+    }
+    double t = benchNow() - t0;
+    fprintf(out, "single,%zu,%zu,%zu,%.6f,%.3f\n", nkeys, nlookups, found, t, (double)nlookups / t / 1e6);
+    t0 = benchNow();
+    found = htExistKeyBatch(ht, ptrs, lengths, nlookups, results);
+    t = benchNow() - t0;
+    fprintf(out, "batch,%zu,%zu,%zu,%.6f,%.3f\n", nkeys, nlookups, found, t, (double)nlookups / t / 1e6);
+    destroyHashTable(ht);
+    free(results);
+    free(lengths);
+    free(ptrs);
+    free(procurar);
+    free(keys);
+}
+
+/**
+ * @brief procedimento para comparar os nodos normais com os nodos com a chave copiada (htSetInlineKeys)
+ * sobre um corpus de strings: memória da tabela (sem contar as strings do corpus), construção e "rounds"
+ * pesquisas de todas as chaves por ordem aleatória (as chaves pesquisadas são cópias, não os apontadores guardados).
+ * CSV: mode,keys,build_s,heap_bytes,heap_bytes_per_key,lookups,lookup_s,mlookups
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ * @param rounds
+ */
+void benchHashTableInlineKeys(FILE *out, char **keys, size_t nkeys, int rounds)
+{
+    assert(out && keys && nkeys > 0 && rounds > 0);
+    char **procurar = (char **)malloc(nkeys * sizeof(char *));
+    assert(procurar);
+    unsigned long long s = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        procurar[i] = strdup(keys[i]);
+        assert(procurar[i]);
+    }
+    for (size_t i = nkeys - 1; i > 0; i--)
+    {
+        size_t j = (size_t)(benchRand(&s) % (i + 1));
+        char *tmp = procurar[i];
+        procurar[i] = procurar[j];
+        procurar[j] = tmp;
+    }
+    fprintf(out, "mode,keys,build_s,heap_bytes,heap_bytes_per_key,lookups,lookup_s,mlookups\n");
+    for (int inl = 0; inl <= 1; inl++)
+    {
+        struct mallinfo2 mi = mallinfo2();
+        size_t antes = mi.uordblks + mi.hblkhd;
+        double t0 = benchNow();
+        HashTableCFG *ht = newHashTableHashKey(nkeys, WYHash, fakeHashDestroy, benchGetString);
+        if (inl)
+            htSetInlineKeys(ht);
+        for (size_t i = 0; i < nkeys; i++)
+        {
+            htInsertData(ht, keys[i]);
+        }
+        double tBuild = benchNow() - t0;
+        mi = mallinfo2();
+        size_t bytes = mi.uordblks + mi.hblkhd - antes;
+        size_t found = 0;
+        t0 = benchNow();
+        for (int r = 0; r < rounds; r++)
+        {
+            for (size_t i = 0; i < nkeys; i++)
+            {
+                found += htExistString(ht, procurar[i]) ? 1 : 0;
+            }
+        }
+        double t = benchNow() - t0;
+        assert(found == nkeys * (size_t)rounds);
+        fprintf(out, "%s,%zu,%.6f,%zu,%.2f,%zu,%.6f,%.3f\n", inl ? "inline" : "pointer", ht->totalItems, tBuild, bytes,
+                (double)bytes / (double)ht->totalItems, found, t, (double)found / t / 1e6);
+        destroyHashTable(ht);
+    }
+    for (size_t i = 0; i < nkeys; i++)
+    {
+        free(procurar[i]);
+    }
+    free(procurar);
+}
+
+/**
+ * @brief procedimento para comparar o dimensionamento com M primo ("%") com M potência de 2 (máscara e redução
+ * de Lemire sobre o hash misturado), com cada função de "hash_known_algorithms.c": a construção começa com
+ * "nkeys / 8" linhas (para incluir os crescimentos); as pesquisas ("rounds" vezes todas as chaves) são feitas numa
+ * segunda tabela criada já com a potência de 2 seguinte a "nkeys" (o primo mais próximo no modo primo), para que
+ * todos os modos tenham o mesmo fator de carga e a diferença venha só da redução do hash à linha.
+ * CSV: hash,sizing,M,keys,load_factor,build_s,lookup_s,mlookups,max_chain,empty_rows (M e o resto da tabela das pesquisas)
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ * @param rounds
+ */
+void benchHashTableSizing(FILE *out, char **keys, size_t nkeys, int rounds)
+{
+    assert(out && keys && nkeys > 0 && rounds > 0);
+    static const char *nomes[] = {"prime", "pow2-mask", "pow2-fastrange"};
+    static const HashTableSizing modos[] = {HT_SIZING_PRIME, HT_SIZING_POW2_MASK, HT_SIZING_POW2_FASTRANGE};
+    size_t p2 = 1;
+    while (p2 < nkeys)
+        p2 <<= 1;
+    fprintf(out, "hash,sizing,M,keys,load_factor,build_s,lookup_s,mlookups,max_chain,empty_rows\n");
+    for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+    {
+        for (int m = 0; m < 3; m++)
+        {
+            double t0 = benchNow();
+            HashTableCFG *ht = newHashTableHashKey(nkeys / 8 + 1, hashKnownAlgorithms[f].func, fakeHashDestroy, benchGetString);
+            htSetSizing(ht, modos[m]);
+            for (size_t i = 0; i < nkeys; i++)
+            {
+                htInsertData(ht, keys[i]);
+            }
+            htRehashAll(ht);
+            double tBuild = benchNow() - t0;
+            destroyHashTable(ht);
+
+            // com fator de carga <= 1 a tabela das pesquisas não cresce; htSetSizing arredonda o primo da criação
+            // para a potência de 2 seguinte, por isso nos modos potência de 2 cria-se com um primo entre p2 / 2 e p2
+            ht = newHashTableHashKey(modos[m] == HT_SIZING_PRIME ? p2 : p2 / 2 + 1, hashKnownAlgorithms[f].func, fakeHashDestroy, benchGetString);
+            htSetSizing(ht, modos[m]);
+            for (size_t i = 0; i < nkeys; i++)
+            {
+                htInsertData(ht, keys[i]);
+            }
+            htRehashAll(ht);
+            size_t found = 0;
+            t0 = benchNow();
+            for (int r = 0; r < rounds; r++)
+            {
+                for (size_t i = 0; i < nkeys; i++)
+                {
+                    found += htExistString(ht, keys[i]) ? 1 : 0;
+                }
+            }
+            double t = benchNow() - t0;
+            htStatsCalc(ht);
+            fprintf(out, "%s,%s,%zu,%zu,%.4f,%.6f,%.6f,%.3f,%zu,%zu\n", hashKnownAlgorithms[f].name, nomes[m], ht->M, ht->totalItems,
+                    (double)ht->totalItems / (double)ht->M, tBuild, t, (double)found / t / 1e6, ht->StatsMax, ht->EmptyRow);
+            destroyHashTable(ht);
+        }
+    }
+}
+
+/**
+ * @brief procedimento para medir a carga paralela (htInsertDataParallel) de 1 até "maxThreads" threads,
+ * a partir de uma tabela pequena (16 linhas) para incluir o dimensionamento. A primeira linha mede a carga
+ * com htInsertData item a item, a referência do "speedup"; cada medição é a melhor de "rounds" repetições.
+ * CSV: mode,threads,keys,inserted,M,seconds,mkeys,speedup
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ * @param maxThreads
+ * @param rounds
+ */
+void benchHashTableParallelBuild(FILE *out, char **keys, size_t nkeys, int maxThreads, int rounds)
+{
+    assert(out && keys && nkeys > 0 && maxThreads > 0 && rounds > 0);
+    fprintf(out, "mode,threads,keys,inserted,M,seconds,mkeys,speedup\n");
+    double base = 0;
+    for (int n = 0; n <= maxThreads; n++)
+    {
+        double best = 0;
+        size_t novos = 0, m = 0;
+        for (int r = 0; r < rounds; r++)
+        {
+            HashTableCFG *ht = newHashTableHashKey(16, WYHash, fakeHashDestroy, benchGetString);
+            double t0 = benchNow();
+            if (n == 0)
+            {
+                for (size_t i = 0; i < nkeys; i++)
+                {
+                    htInsertData(ht, keys[i]);
+                }
+                htRehashAll(ht);
+            }
+            else
+            {
+                htInsertDataParallel(ht, (void **)keys, nkeys, n, NULL);
+            }
+            double t = benchNow() - t0;
+            if (r == 0 || t < best)
+                best = t;
+            novos = ht->totalItems;
+            m = ht->M;
+            destroyHashTable(ht);
+        }
+        if (n == 0)
+            base = best;
+        fprintf(out, "%s,%d,%zu,%zu,%zu,%.6f,%.3f,%.3f\n", n == 0 ? "serial" : "parallel", n ? n : 1, nkeys, novos, m,
+                best, (double)nkeys / best / 1e6, base / best);
+    }
+}
+
+/**
+ * @brief procedimento para mostrar a escolha automática da função de hash (htSetAutoHash) sobre um corpus:
+ * uma linha por função com as medições sobre a amostra (as primeiras "sample" chaves) e a indicação da escolhida,
+ * seguida da carga completa e das pesquisas com cada função, para comparar a escolha com as restantes.
+ * CSV: hash,chosen,ns_key,variance_ratio,avg_probes,max_chain,build_s,lookup_s,max_chain_full
+ *
+ * @param out
+ * @param keys
+ * @param nkeys
+ * @param sample
+ */
+void benchHashTableAutoHash(FILE *out, char **keys, size_t nkeys, size_t sample)
+{
+    assert(out && keys && nkeys > 0 && sample > 1);
+    size_t n = sample < nkeys ? sample : nkeys;
+    unsigned int *lengths = (unsigned int *)malloc(n * sizeof(unsigned int));
+    HashTableHashReport *r = (HashTableHashReport *)malloc((size_t)hashKnownAlgorithmsCount * sizeof(HashTableHashReport));
+    assert(lengths && r);
+    for (size_t i = 0; i < n; i++)
+    {
+        lengths[i] = (unsigned int)strlen(keys[i]);
+    }
+    HashTableCFG *ht = newHashTableHashKey(16, DJBHash, fakeHashDestroy, benchGetString);
+    int escolhida = htSelectHashKey(ht, (const void **)keys, lengths, n, r);
+    destroyHashTable(ht);
+
+    fprintf(out, "hash,chosen,ns_key,variance_ratio,avg_probes,max_chain,build_s,lookup_s,max_chain_full\n");
+    for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+    {
+        double t0 = benchNow();
+        ht = newHashTableHashKey(16, hashKnownAlgorithms[f].func, fakeHashDestroy, benchGetString);
+        for (size_t i = 0; i < nkeys; i++)
+        {
+            htInsertData(ht, keys[i]);
+        }
+        htRehashAll(ht);
+        double tBuild = benchNow() - t0;
+        t0 = benchNow();
+        for (size_t i = 0; i < nkeys; i++)
+        {
+            htExistString(ht, keys[i]);
+        }
+        double tLookup = benchNow() - t0;
+        htStatsCalc(ht);
+        fprintf(out, "%s,%d,%.3f,%.3f,%.3f,%zu,%.6f,%.6f,%zu\n", r[f].name, f == escolhida ? 1 : 0, r[f].nsPerKey,
+                r[f].varianceRatio, r[f].avgProbes, r[f].maxChain, tBuild, tLookup, ht->StatsMax);
+        destroyHashTable(ht);
+    }
+    free(r);
+    free(lengths);
+}
+
+/**
+ * @brief procedimento para medir a contagem de palavras de um ficheiro: "mmap" é wcIngestFile (palavras pesquisadas
+ * no ficheiro mapeado, só as novas são copiadas); "strdup" é a referência em que o ficheiro é lido linha a linha
+ * com "getline" e cada palavra é copiada antes de htInsertData (a cópia é libertada se a palavra já existia).
+ * As duas usam a mesma separação de palavras (wcNextToken) e o mesmo tipo de tabela.
+ * CSV: mode,bytes,tokens,distinct,seconds,mb_s,tokens_s
+ *
+ * @param out
+ * @param path
+ * @return true
+ * @return false se não foi possível ler o ficheiro
+ */
+bool benchWordCount(FILE *out, const char *path)
+{
+    assert(out && path);
+    WordCountStats stats;
+    HashTableCFG *ht = newWordCountTable(1024);
+    if (!wcIngestFile(ht, path, &stats))
+    {
+        destroyHashTable(ht);
+        return false;
+    }
+    fprintf(out, "mode,bytes,tokens,distinct,seconds,mb_s,tokens_s\n");
+    fprintf(out, "mmap,%zu,%llu,%zu,%.6f,%.3f,%.0f\n", stats.bytes, stats.tokens, ht->totalItems, stats.seconds,
+            stats.mbPerSec, stats.tokensPerSec);
+    destroyHashTable(ht);
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+    ht = newWordCountTable(1024);
+    double t0 = benchNow();
+    char *line = NULL;
+    size_t cap = 0, bytes = 0;
+    unsigned long long tokens = 0;
+    ssize_t l;
+    while ((l = getline(&line, &cap, f)) > 0)
+    {
+        const char *p = line, *end = line + l;
+        size_t length;
+        while ((p = wcNextToken(p, end, &length)) != NULL)
+        {
+            char *word = (char *)wcNewWord(p, (unsigned int)length);
+            if (!htInsertData(ht, word))
+                free(word);
+            tokens++;
+            p += length;
+        }
+        bytes += (size_t)l;
+    }
+    double t = benchNow() - t0;
+    fprintf(out, "strdup,%zu,%llu,%zu,%.6f,%.3f,%.0f\n", bytes, tokens, ht->totalItems, t, (double)bytes / t / 1e6,
+            (double)tokens / t);
+    free(line);
+    fclose(f);
+    destroyHashTable(ht);
+    return true;
+}
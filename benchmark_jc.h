@@ -0,0 +1,38 @@
+/**
+ * @file benchmark_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface das funções de medição de desempenho das estruturas.
+ * Todos os resultados são escritos em formato CSV (uma linha de cabeçalho e uma linha por medição)
+ * para poderem ser comparados entre versões.
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_BENCHMARK_JC_H
+#define INC_14AED2HASH_BENCHMARK_JC_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+double benchNow(void);
+
+char **benchLoadKeys(const char *path, size_t *nkeys);
+char **benchFreeKeys(char **keys, size_t nkeys);
+
+void benchHashThroughput(FILE *out, char **keys, size_t nkeys);
+void benchHashDistribution(FILE *out, char **keys, size_t nkeys, const size_t *tableSizes, size_t nsizes);
+
+void benchHashTableMTScaling(FILE *out, size_t nkeys, int maxThreads, size_t opsPerThread, int updatePercent);
+void benchHashTableSlab(FILE *out, size_t nkeys, size_t nodesPerBlock);
+void benchHashTableBatch(FILE *out, size_t nkeys, size_t nlookups);
+void benchHashTableInlineKeys(FILE *out, char **keys, size_t nkeys, int rounds);
+void benchHashTableSizing(FILE *out, char **keys, size_t nkeys, int rounds);
+void benchHashTableParallelBuild(FILE *out, char **keys, size_t nkeys, int maxThreads, int rounds);
+void benchHashTableAutoHash(FILE *out, char **keys, size_t nkeys, size_t sample);
+bool benchWordCount(FILE *out, const char *path);
+
+#endif //INC_14AED2HASH_BENCHMARK_JC_H
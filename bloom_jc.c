@@ -0,0 +1,118 @@
+/**
+ * @file bloom_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação de um filtro de Bloom por blocos. O utilizador fornece um hash de 64 bits por chave:
+ * os 32 bits mais altos escolhem o bloco e os restantes geram os "k" bits dentro do bloco (duplo hashing).
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <math.h>
+#include <assert.h>
+#include <malloc.h>
+#include "bloom_jc.h"
+
+/**
+ * @brief função que devolve o primeiro bloco da chave (NOTA: é uma função interna)
+ * redução multiplicativa dos 32 bits mais altos, evita a divisão
+ *
+ * @param bf
+ * @param hash
+ * @return unsigned long long*
+ */
+unsigned long long *bloomBlock(const BloomFilter *bf, unsigned long long hash)
+{
+    unsigned long long b = ((hash >> 32) * (unsigned long long)bf->nblocks) >> 32;
+    return bf->bits + b * BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * @brief procedimento para adicionar ao filtro a chave com o hash "hash"
+ *
+ * @param bf
+ * @param hash
+ */
+void bloomAdd(BloomFilter *bf, unsigned long long hash)
+{
+    unsigned long long *block = bloomBlock(bf, hash);
+    unsigned int h1 = (unsigned int)hash;
+    unsigned int h2 = (h1 >> 16) | (h1 << 16) | 1;
+    for (int i = 0; i < bf->k; i++, h1 += h2)
+    {
+        unsigned int bit = h1 & (BLOOM_BLOCK_WORDS * 64 - 1);
+        block[bit >> 6] |= 1ULL << (bit & 63);
+    }
+    bf->items++;
+}
+
+/**
+ * @brief função para verificar se a chave com o hash "hash" pode estar no filtro
+ *
+ * @param bf
+ * @param hash
+ * @return true talvez exista
+ * @return false não existe de certeza
+ */
+bool bloomMayContain(const BloomFilter *bf, unsigned long long hash)
+{
+    const unsigned long long *block = bloomBlock(bf, hash);
+    unsigned int h1 = (unsigned int)hash;
+    unsigned int h2 = (h1 >> 16) | (h1 << 16) | 1;
+    for (int i = 0; i < bf->k; i++, h1 += h2)
+    {
+        unsigned int bit = h1 & (BLOOM_BLOCK_WORDS * 64 - 1);
+        if (!(block[bit >> 6] & (1ULL << (bit & 63))))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief função para destruir o filtro
+ *
+ * @param bf
+ * @return BloomFilter*
+ */
+BloomFilter *destroyBloomFilter(BloomFilter *bf)
+{
+    assert(bf);
+    free(bf->bits);
+    free(bf);
+    return NULL;
+}
+
+/**
+ * @brief função para criar um filtro para "capacity" chaves com a taxa de falsos positivos "fpRate" (ex: 0.01)
+ * bits por chave = -ln(p) / ln(2)^2 e k = bits por chave * ln(2); os blocos aumentam um pouco a taxa real
+ *
+ * @param capacity
+ * @param fpRate
+ * @return BloomFilter*
+ */
+BloomFilter *newBloomFilter(size_t capacity, double fpRate)
+{
+    assert(fpRate > 0 && fpRate < 1);
+    BloomFilter *novo = (BloomFilter *)malloc(sizeof(BloomFilter));
+    assert(novo);
+    if (capacity < 1)
+        capacity = 1;
+    double bitsPorChave = -log(fpRate) / (log(2) * log(2));
+    double bits = bitsPorChave * (double)capacity;
+    novo->nblocks = (size_t)ceil(bits / (BLOOM_BLOCK_WORDS * 64));
+    novo->k = (int)lround(bitsPorChave * log(2));
+    if (novo->k < 1)
+        novo->k = 1;
+    novo->capacity = capacity;
+    novo->items = 0;
+    novo->fpRate = fpRate;
+    novo->bits = (unsigned long long *)memalign(64, novo->nblocks * BLOOM_BLOCK_WORDS * sizeof(unsigned long long));
+    assert(novo->bits);
+    for (size_t i = 0; i < novo->nblocks * BLOOM_BLOCK_WORDS; i++)
+    {
+        novo->bits[i] = 0;
+    }
+    return novo;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file bloom_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface de um filtro de Bloom por blocos: cada chave só toca numa linha de cache (512 bits).
+ * Responde "não existe" com certeza ou "talvez exista" com a taxa de falsos positivos configurada.
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_BLOOM_JC_H
+#define INC_14AED2HASH_BLOOM_JC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief número de palavras de 64 bits de cada bloco (8 x 64 = 512 bits = uma linha de cache)
+ */
+#define BLOOM_BLOCK_WORDS 8
+
+typedef struct bloomfilter BloomFilter;
+struct bloomfilter {
+    unsigned long long *bits;   /**< blocos do filtro. */
+    size_t nblocks;             /**< número de blocos. */
+    int k;                      /**< bits ligados por chave. */
+    size_t capacity;            /**< número de chaves para o qual foi dimensionado. */
+    size_t items;               /**< chaves adicionadas. */
+    double fpRate;              /**< taxa de falsos positivos pretendida. */
+};
+
+BloomFilter *newBloomFilter(size_t capacity, double fpRate);
+BloomFilter *destroyBloomFilter(BloomFilter *bf);
+void bloomAdd(BloomFilter *bf, unsigned long long hash);
+bool bloomMayContain(const BloomFilter *bf, unsigned long long hash);
+
+#endif //INC_14AED2HASH_BLOOM_JC_H
@@ -213,11 +213,11 @@ int calcBTreeDepth(BTree *lista) {
  * @param node
  * @return total de elementos
  */
-int calcBTreeNodeSize(BTreeNode *node) {
-    int resultado=0;
+size_t calcBTreeNodeSize(BTreeNode *node) {
+    size_t resultado=0;
     if (node) {
-        int dLeft=calcBTreeNodeSize(node->left);
-        int dRight=calcBTreeNodeSize(node->right);
+        size_t dLeft=calcBTreeNodeSize(node->left);
+        size_t dRight=calcBTreeNodeSize(node->right);
         resultado=1+dLeft+dRight;
     }
     return resultado;
@@ -228,7 +228,7 @@ int calcBTreeNodeSize(BTreeNode *node) {
  * @param lista
  * @return total de elementos
  */
-int calcBTreeSize(BTree *lista) {
+size_t calcBTreeSize(BTree *lista) {
     assert(lista);
     return calcBTreeNodeSize(lista->root);
 }
@@ -257,29 +257,29 @@ void traverseBTree(BTree *lista, TtraverseBTreeProc procIterar, void *ctxExterno
     traverseBTree_rec(lista->root, procIterar, ctxExterno);
 }
 
-ArrayStartSeteNodos *newArrayStartSeteNodos(int listsize) {
+ArrayStartSeteNodos *newArrayStartSeteNodos(size_t listsize) {
     ArrayStartSeteNodos *novo=(ArrayStartSeteNodos*)malloc(sizeof(ArrayStartSeteNodos));
     assert(novo);
     // TODO: retomar a este assunto para avaliar opções de otimização
-    novo->lista[0].posicao=(int)(listsize*0.12f);
+    novo->lista[0].posicao=(size_t)((double)listsize*0.12);
     novo->lista[0].dataKey=NULL;
 
-    novo->lista[1].posicao=(int)(listsize*0.25f);
+    novo->lista[1].posicao=(size_t)((double)listsize*0.25);
     novo->lista[1].dataKey=NULL;
 
-    novo->lista[2].posicao=(int)(listsize*0.37f);
+    novo->lista[2].posicao=(size_t)((double)listsize*0.37);
     novo->lista[2].dataKey=NULL;
 
-    novo->lista[3].posicao=(int)(listsize*0.5f);
+    novo->lista[3].posicao=(size_t)((double)listsize*0.5);
     novo->lista[3].dataKey=NULL;
 
-    novo->lista[4].posicao=(int)(listsize*0.62f);
+    novo->lista[4].posicao=(size_t)((double)listsize*0.62);
     novo->lista[4].dataKey=NULL;
 
-    novo->lista[5].posicao=(int)(listsize*0.75f);
+    novo->lista[5].posicao=(size_t)((double)listsize*0.75);
     novo->lista[5].dataKey=NULL;
 
-    novo->lista[6].posicao=(int)(listsize*0.87f);
+    novo->lista[6].posicao=(size_t)((double)listsize*0.87);
     novo->lista[6].dataKey=NULL;
 
     return novo;
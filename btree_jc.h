@@ -14,6 +14,7 @@
 #define INC_09_AED2_V1_BTREE_JC_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief estrutura principal e básica da árvore genérica
@@ -56,7 +57,7 @@ struct btree {
  */
 typedef struct arraysetenodositem ArraySeteNodosItem;
 struct arraysetenodositem {
-    int posicao;    /**< posição numérica da lista a otimizar. */
+    size_t posicao; /**< posição numérica da lista a otimizar. */
     void *dataKey;  /**< apontador para a chave a indexar. */
 };
 
@@ -80,9 +81,9 @@ BTree *destroyBTree(BTree *lista);
 bool insert_BTreeNode(BTree *lista, void *key);
 bool searchBTreeByKey(BTree *lista, void *key);
 int calcBTreeDepth(BTree *lista);
-int calcBTreeSize(BTree *lista);
+size_t calcBTreeSize(BTree *lista);
 void traverseBTree(BTree *lista, TtraverseBTreeProc procIterar, void *ctxExterno);
 void fakeDestroyBTreeNodeKey(void *key);
-ArrayStartSeteNodos *newArrayStartSeteNodos(int listsize);
+ArrayStartSeteNodos *newArrayStartSeteNodos(size_t listsize);
 
 #endif //INC_09_AED2_V1_BTREE_JC_H
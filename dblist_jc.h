@@ -13,6 +13,8 @@
 #ifndef INC_01_AED2_V0_DBLIST_JC_H
 #define INC_01_AED2_V0_DBLIST_JC_H
 
+#include <stddef.h>
+
 /**
  * @brief estrutura genérica para lista duplamente ligada
  *
@@ -115,7 +117,7 @@ struct intCfgDBLGenerica
 {
     int id;                                      /**< ID caso seja necessário identificar a lista. */
     char *nome;                                  /**< nome a associar a esta lista. */
-    int totalItems;                              /**< total de itens na lista. */
+    size_t totalItems;                           /**< total de itens na lista. */
     TipoResultadoOperacaoDBLGenerica lastResult; /**< resultado da última operação. */
     TipoOrdemDBLGenerica tipoOrdemDados;         /**< tipo de ordem da lista. */
     TipoDeDadosDBLGenerica tipoDados;            /**< dados REPETIDOS ou ÚNICOS. */
@@ -11,8 +11,17 @@
  *
  */
 
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HKA_AVX2_DISPATCH 1
+#endif
 #include "hash_known_algorithms.h"
 
+#define HKA_STRIPE_LEN 32         // bytes consumed per step by the Stripe Hash
+#define HKA_STRIPES_PER_BLOCK 16  // stripes between two scrambles of the accumulators
+#define HKA_STRIPE_PRIME 0x9E3779B1ULL
+
 /**
 00 - RS Hash Function
 A simple hash function from Robert Sedgwicks Algorithms in C book. I've added some simple optimizations to the algorithm in order to speed up its hashing process.
@@ -187,3 +196,516 @@ unsigned int APHash(const char *str, unsigned int length)
 
     return hash;
 }
+
+/*
+ * helpers for the word-at-a-time functions (09 and 10)
+ * keys are read with memcpy so they don't need any alignment
+ */
+static inline unsigned long long hkaRead64(const char *p)
+{
+    unsigned long long v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline unsigned long long hkaRead32(const char *p)
+{
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 64x64 -> 128 bit multiplication, low half in "a" and high half in "b"
+static inline void hkaMum(unsigned long long *a, unsigned long long *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)(*a) * (*b);
+    (*a) = (unsigned long long)r;
+    (*b) = (unsigned long long)(r >> 64);
+#else
+    unsigned long long ha = (*a) >> 32, hb = (*b) >> 32, la = (unsigned int)(*a), lb = (unsigned int)(*b);
+    unsigned long long rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    unsigned long long t = rl + (rm0 << 32), c = t < rl;
+    unsigned long long lo = t + (rm1 << 32);
+    c += lo < t;
+    (*a) = lo;
+    (*b) = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline unsigned long long hkaMix(unsigned long long a, unsigned long long b)
+{
+    hkaMum(&a, &b);
+    return a ^ b;
+}
+
+static const unsigned long long hkaWyp[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+/**
+09 - WY Hash Function
+Port of wyhash (final version 4) by Wang Yi.
+*/
+unsigned long long WYHash64Seed(const char *str, unsigned int length, unsigned long long seed)
+{
+    const char *p = str;
+    unsigned long long a, b;
+    seed ^= hkaMix(seed ^ hkaWyp[0], hkaWyp[1]);
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            a = (hkaRead32(p) << 32) | hkaRead32(p + ((length >> 3) << 2));
+            b = (hkaRead32(p + length - 4) << 32) | hkaRead32(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            const unsigned char *u = (const unsigned char *)p;
+            a = ((unsigned long long)u[0] << 16) | ((unsigned long long)u[length >> 1] << 8) | u[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        unsigned int i = length;
+        if (i >= 48)
+        {
+            unsigned long long see1 = seed, see2 = seed;
+            do
+            {
+                seed = hkaMix(hkaRead64(p) ^ hkaWyp[1], hkaRead64(p + 8) ^ seed);
+                see1 = hkaMix(hkaRead64(p + 16) ^ hkaWyp[2], hkaRead64(p + 24) ^ see1);
+                see2 = hkaMix(hkaRead64(p + 32) ^ hkaWyp[3], hkaRead64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = hkaMix(hkaRead64(p) ^ hkaWyp[1], hkaRead64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // the last 16 bytes of the key (may overlap bytes already consumed)
+        a = hkaRead64(p + i - 16);
+        b = hkaRead64(p + i - 8);
+    }
+    a ^= hkaWyp[1];
+    b ^= seed;
+    hkaMum(&a, &b);
+    return hkaMix(a ^ hkaWyp[0] ^ length, b ^ hkaWyp[1]);
+}
+
+unsigned long long WYHash64(const char *str, unsigned int length)
+{
+    return WYHash64Seed(str, length, 0);
+}
+
+unsigned int WYHash(const char *str, unsigned int length)
+{
+    unsigned long long h = WYHash64Seed(str, length, 0);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+/*
+ * 10 - Stripe Hash Function: stripe loop (portable and AVX2) and finalization
+ */
+static const unsigned long long hkaStripeSecret[4] = {0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL};
+
+static inline void hkaStripeScramble(unsigned long long acc[4])
+{
+    for (int i = 0; i < 4; i++)
+    {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= hkaStripeSecret[i];
+        acc[i] *= HKA_STRIPE_PRIME;
+    }
+}
+
+void hkaStripeAccumulateScalar(unsigned long long acc[4], const char *p, unsigned int nstripes, unsigned int *count)
+{
+    for (unsigned int n = 0; n < nstripes; n++, p += HKA_STRIPE_LEN)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            unsigned long long d = hkaRead64(p + 8 * i);
+            unsigned long long dk = d ^ hkaStripeSecret[i];
+            acc[i] += (dk & 0xFFFFFFFFULL) * (dk >> 32);
+            acc[i ^ 1] += d;
+        }
+        if (++(*count) % HKA_STRIPES_PER_BLOCK == 0)
+            hkaStripeScramble(acc);
+    }
+}
+
+#if defined(HKA_AVX2_DISPATCH)
+__attribute__((target("avx2"))) void hkaStripeAccumulateAVX2(unsigned long long acc[4], const char *p, unsigned int nstripes, unsigned int *count)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)acc);
+    const __m256i k = _mm256_loadu_si256((const __m256i *)hkaStripeSecret);
+    const __m256i prime = _mm256_set1_epi64x(HKA_STRIPE_PRIME);
+    for (unsigned int n = 0; n < nstripes; n++, p += HKA_STRIPE_LEN)
+    {
+        __m256i d = _mm256_loadu_si256((const __m256i *)p);
+        __m256i dk = _mm256_xor_si256(d, k);
+        // low 32 bits * high 32 bits of each lane, plus the data of the neighbour lane (i ^ 1)
+        __m256i prod = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+        __m256i swap = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        a = _mm256_add_epi64(a, _mm256_add_epi64(prod, swap));
+        if (++(*count) % HKA_STRIPES_PER_BLOCK == 0)
+        {
+            a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+            a = _mm256_xor_si256(a, k);
+            // 64 x 32 bit multiplication done in two halves
+            __m256i lo = _mm256_mul_epu32(a, prime);
+            __m256i hi = _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime), 32);
+            a = _mm256_add_epi64(lo, hi);
+        }
+    }
+    _mm256_storeu_si256((__m256i *)acc, a);
+}
+#endif
+
+void hkaStripeAccumulate(unsigned long long acc[4], const char *p, unsigned int nstripes, unsigned int *count)
+{
+#if defined(HKA_AVX2_DISPATCH)
+    if (nstripes > 1 && __builtin_cpu_supports("avx2"))
+    {
+        hkaStripeAccumulateAVX2(acc, p, nstripes, count);
+        return;
+    }
+#endif
+    hkaStripeAccumulateScalar(acc, p, nstripes, count);
+}
+
+void hkaStripeInit(unsigned long long acc[4], unsigned long long seed)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        acc[i] = hkaStripeSecret[i] ^ seed;
+    }
+}
+
+unsigned long long hkaStripeFinal(const unsigned long long acc[4], const char *tail, unsigned int tailLength, unsigned long long total, unsigned long long seed)
+{
+    unsigned long long h = total * 0x9E3779B185EBCA87ULL ^ seed;
+    h = hkaMix(acc[0] ^ hkaWyp[0], acc[1] ^ h) ^ hkaMix(acc[2] ^ hkaWyp[1], acc[3] ^ h);
+    // tail (< 32 bytes): 16 bytes per step, the last 1..16 bytes read like the short keys of WYHash
+    while (tailLength > 16)
+    {
+        h = hkaMix(hkaRead64(tail) ^ hkaWyp[2], hkaRead64(tail + 8) ^ h);
+        tail += 16;
+        tailLength -= 16;
+    }
+    if (tailLength >= 4)
+    {
+        unsigned long long a = (hkaRead32(tail) << 32) | hkaRead32(tail + ((tailLength >> 3) << 2));
+        unsigned long long b = (hkaRead32(tail + tailLength - 4) << 32) | hkaRead32(tail + tailLength - 4 - ((tailLength >> 3) << 2));
+        h = hkaMix(a ^ hkaWyp[2], b ^ h);
+    }
+    else if (tailLength > 0)
+    {
+        const unsigned char *u = (const unsigned char *)tail;
+        unsigned long long a = ((unsigned long long)u[0] << 16) | ((unsigned long long)u[tailLength >> 1] << 8) | u[tailLength - 1];
+        h = hkaMix(a ^ hkaWyp[2], h ^ hkaWyp[3]);
+    }
+    // final avalanche (fmix64 from MurmurHash3)
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+10 - Stripe Hash Function
+XXH3-style striped hash, 32 bytes per step.
+*/
+unsigned long long StripeHash64Seed(const char *str, unsigned int length, unsigned long long seed)
+{
+    unsigned long long acc[4];
+    unsigned int count = 0;
+    unsigned int nstripes = length / HKA_STRIPE_LEN;
+    hkaStripeInit(acc, seed);
+    hkaStripeAccumulate(acc, str, nstripes, &count);
+    return hkaStripeFinal(acc, str + nstripes * HKA_STRIPE_LEN, length % HKA_STRIPE_LEN, length, seed);
+}
+
+unsigned long long StripeHash64(const char *str, unsigned int length)
+{
+    return StripeHash64Seed(str, length, 0);
+}
+
+unsigned int StripeHash(const char *str, unsigned int length)
+{
+    unsigned long long h = StripeHash64Seed(str, length, 0);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+/**
+ * list of all the functions in this file (same order as the numbering above)
+ */
+const HashKnownAlgorithmInfo hashKnownAlgorithms[] = {
+    {"RS", RSHash},
+    {"JS", JSHash},
+    {"PJW", PJWHash},
+    {"ELF", ELFHash},
+    {"BKDR", BKDRHash},
+    {"SDBM", SDBMHash},
+    {"DJB", DJBHash},
+    {"DEK", DEKHash},
+    {"AP", APHash},
+    {"WY", WYHash},
+    {"STRIPE", StripeHash},
+};
+
+const int hashKnownAlgorithmsCount = (int)(sizeof(hashKnownAlgorithms) / sizeof(hashKnownAlgorithms[0]));
+
+/*
+ * incremental (init/update/final) versions of all the functions above
+ */
+
+void hashKnownStreamInitSeed(HashKnownStream *st, HashKnownAlgorithmId algorithm, unsigned long long seed)
+{
+    memset(st, 0, sizeof(HashKnownStream));
+    st->algorithm = algorithm;
+    st->seed = seed;
+    switch (algorithm)
+    {
+    case HKA_RS:
+        st->a = 63689;
+        break;
+    case HKA_JS:
+        st->hash = 1315423911;
+        break;
+    case HKA_DJB:
+        st->hash = 5381;
+        break;
+    case HKA_AP:
+        st->hash = 0xAAAAAAAA;
+        break;
+    case HKA_WY:
+        st->wy[0] = seed ^ hkaMix(seed ^ hkaWyp[0], hkaWyp[1]);
+        break;
+    case HKA_STRIPE:
+        hkaStripeInit(st->acc, seed);
+        break;
+    default:
+        // DEK starts with the length of the key, which is only known at the end (see hashKnownStreamFinal)
+        break;
+    }
+}
+
+void hashKnownStreamInit(HashKnownStream *st, HashKnownAlgorithmId algorithm)
+{
+    hashKnownStreamInitSeed(st, algorithm, 0);
+}
+
+// WY: consumes one 48 byte block
+static void hkaStreamWYBlock(HashKnownStream *st, const char *p)
+{
+    if (st->blocks == 0)
+        st->wy[1] = st->wy[2] = st->wy[0];
+    st->wy[0] = hkaMix(hkaRead64(p) ^ hkaWyp[1], hkaRead64(p + 8) ^ st->wy[0]);
+    st->wy[1] = hkaMix(hkaRead64(p + 16) ^ hkaWyp[2], hkaRead64(p + 24) ^ st->wy[1]);
+    st->wy[2] = hkaMix(hkaRead64(p + 32) ^ hkaWyp[3], hkaRead64(p + 40) ^ st->wy[2]);
+    memcpy(st->last16, p + 32, 16);
+    st->blocks++;
+}
+
+// WY and STRIPE: complete blocks of "block" bytes are consumed as soon as they are available,
+// the one-shot functions consume them too whatever the rest of the key is
+static void hkaStreamBlocks(HashKnownStream *st, const char *p, unsigned int length, unsigned int block)
+{
+    if (st->bufLength > 0)
+    {
+        unsigned int n = block - st->bufLength < length ? block - st->bufLength : length;
+        memcpy(st->buf + st->bufLength, p, n);
+        st->bufLength += n;
+        p += n;
+        length -= n;
+        if (st->bufLength < block)
+            return;
+        if (st->algorithm == HKA_WY)
+            hkaStreamWYBlock(st, st->buf);
+        else
+            hkaStripeAccumulate(st->acc, st->buf, 1, &st->stripes);
+        st->bufLength = 0;
+    }
+    if (st->algorithm == HKA_WY)
+    {
+        for (; length >= block; p += block, length -= block)
+            hkaStreamWYBlock(st, p);
+    }
+    else
+    {
+        unsigned int n = length / block;
+        hkaStripeAccumulate(st->acc, p, n, &st->stripes);
+        p += n * block;
+        length -= n * block;
+    }
+    memcpy(st->buf, p, length);
+    st->bufLength = length;
+}
+
+void hashKnownStreamUpdate(HashKnownStream *st, const char *str, unsigned int length)
+{
+    unsigned int hash = st->hash;
+    unsigned int i = 0;
+    switch (st->algorithm)
+    {
+    case HKA_RS:
+    {
+        unsigned int b = 378551;
+        unsigned int a = st->a;
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = hash * a + (*str);
+            a = a * b;
+        }
+        st->a = a;
+        break;
+    }
+    case HKA_JS:
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash ^= ((hash << 5) + (*str) + (hash >> 2));
+        }
+        break;
+    case HKA_PJW:
+    {
+        const unsigned int BitsInUnsignedInt = (unsigned int)(sizeof(unsigned int) * 8);
+        const unsigned int ThreeQuarters = (unsigned int)((BitsInUnsignedInt * 3) / 4);
+        const unsigned int OneEighth = (unsigned int)(BitsInUnsignedInt / 8);
+        const unsigned int HighBits = (unsigned int)(0xFFFFFFFF) << (BitsInUnsignedInt - OneEighth);
+        unsigned int test = 0;
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = (hash << OneEighth) + (*str);
+            if ((test = hash & HighBits) != 0)
+            {
+                hash = ((hash ^ (test >> ThreeQuarters)) & (~HighBits));
+            }
+        }
+        break;
+    }
+    case HKA_ELF:
+    {
+        unsigned int x = 0;
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = (hash << 4) + (*str);
+            if ((x = hash & 0xF0000000L) != 0)
+            {
+                hash ^= (x >> 24);
+            }
+            hash &= ~x;
+        }
+        break;
+    }
+    case HKA_BKDR:
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = (hash * 131) + (*str);
+        }
+        break;
+    case HKA_SDBM:
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = (*str) + (hash << 6) + (hash << 16) - hash;
+        }
+        break;
+    case HKA_DJB:
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = ((hash << 5) + hash) + (*str);
+        }
+        break;
+    case HKA_DEK:
+        for (i = 0; i < length; ++str, ++i)
+        {
+            hash = ((hash << 5) ^ (hash >> 27)) ^ (*str);
+        }
+        break;
+    case HKA_AP:
+    {
+        // the parity of the position in the whole key, not in this chunk
+        unsigned int k = (unsigned int)st->length;
+        for (i = 0; i < length; ++str, ++i, ++k)
+        {
+            hash ^= ((k & 1) == 0) ? ((hash << 7) ^ (*str) * (hash >> 3)) : (~((hash << 11) + ((*str) ^ (hash >> 5))));
+        }
+        break;
+    }
+    case HKA_WY:
+        hkaStreamBlocks(st, str, length, 48);
+        break;
+    case HKA_STRIPE:
+        hkaStreamBlocks(st, str, length, HKA_STRIPE_LEN);
+        break;
+    }
+    st->hash = hash;
+    st->length += length;
+}
+
+unsigned long long hashKnownStreamFinal64(const HashKnownStream *st)
+{
+    switch (st->algorithm)
+    {
+    case HKA_DEK:
+    {
+        // each step is a rotation by 5 followed by a xor, both linear, so starting from 0 instead of the
+        // length only misses the length rotated by 5 bits per byte
+        unsigned int length = (unsigned int)st->length;
+        unsigned int r = (unsigned int)((st->length * 5) % 32);
+        return st->hash ^ (r ? (length << r) | (length >> (32 - r)) : length);
+    }
+    case HKA_WY:
+    {
+        // keys shorter than 48 bytes are still complete in the buffer
+        if (st->blocks == 0)
+            return WYHash64Seed(st->buf, st->bufLength, st->seed);
+        unsigned long long seed = st->wy[0] ^ st->wy[1] ^ st->wy[2];
+        const char *p = st->buf;
+        unsigned int i = st->bufLength;
+        while (i > 16)
+        {
+            seed = hkaMix(hkaRead64(p) ^ hkaWyp[1], hkaRead64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // the last 16 bytes of the key, part of them may belong to the last block already consumed
+        char last[16];
+        if (st->bufLength >= 16)
+        {
+            memcpy(last, st->buf + st->bufLength - 16, 16);
+        }
+        else
+        {
+            memcpy(last, st->last16 + st->bufLength, 16 - st->bufLength);
+            memcpy(last + 16 - st->bufLength, st->buf, st->bufLength);
+        }
+        unsigned long long a = hkaRead64(last) ^ hkaWyp[1];
+        unsigned long long b = hkaRead64(last + 8) ^ seed;
+        hkaMum(&a, &b);
+        return hkaMix(a ^ hkaWyp[0] ^ (unsigned int)st->length, b ^ hkaWyp[1]);
+    }
+    case HKA_STRIPE:
+        return hkaStripeFinal(st->acc, st->buf, st->bufLength, st->length, st->seed);
+    default:
+        return st->hash;
+    }
+}
+
+unsigned int hashKnownStreamFinal(const HashKnownStream *st)
+{
+    unsigned long long h = hashKnownStreamFinal64(st);
+    if (st->algorithm == HKA_WY || st->algorithm == HKA_STRIPE)
+        return (unsigned int)(h ^ (h >> 32));
+    return (unsigned int)h;
+}
@@ -13,6 +13,17 @@
 #ifndef INC_14AED2HASH_HASH_KNOWN_ALGORITHMS_H
 #define INC_14AED2HASH_HASH_KNOWN_ALGORITHMS_H
 
+/**
+ * @brief type signature shared by all the functions in this file, used by the
+ * structures that compute the full hash of a key themselves
+ */
+typedef unsigned int (*TfuncHashKnownAlgorithm)(const char *str, unsigned int length);
+
+/**
+ * @brief same signature with a 64-bit result (functions 09 and 10)
+ */
+typedef unsigned long long (*TfuncHashKnownAlgorithm64)(const char *str, unsigned int length);
+
 /**
 00 - RS Hash Function
 A simple hash function from Robert Sedgwicks Algorithms in C book. I've added some simple optimizations to the algorithm in order to speed up its hashing process.
@@ -67,4 +78,81 @@ An algorithm produced by me Arash Partow. I took ideas from all of the above has
 */
 unsigned int APHash(const char *str, unsigned int length);
 
+/**
+09 - WY Hash Function
+Port of wyhash (final version 4) by Wang Yi. Reads the key 16 or 48 bytes per step with 64x64->128 bit multiplications,
+so the cost per byte is far lower than the byte-at-a-time functions above. Little-endian reads, 64-bit result.
+WYHash is the 32-bit fold (high ^ low) of WYHash64 for use with the 32-bit signature.
+*/
+unsigned long long WYHash64Seed(const char *str, unsigned int length, unsigned long long seed);
+unsigned long long WYHash64(const char *str, unsigned int length);
+unsigned int WYHash(const char *str, unsigned int length);
+
+/**
+10 - Stripe Hash Function
+XXH3-style striped hash (same construction, not bit-compatible with XXH3): four 64-bit accumulators consume 32 bytes
+per step with 32x32->64 bit multiplications and are scrambled every 512 bytes. The stripe loop runs with AVX2
+(selected at run time) when the CPU supports it and uses a portable path otherwise; both give the same result.
+StripeHash is the 32-bit fold of StripeHash64.
+*/
+unsigned long long StripeHash64Seed(const char *str, unsigned int length, unsigned long long seed);
+unsigned long long StripeHash64(const char *str, unsigned int length);
+unsigned int StripeHash(const char *str, unsigned int length);
+
+/**
+ * @brief name and address of each function in this file, so tools can iterate over all of them
+ */
+typedef struct hashknownalgorithminfo HashKnownAlgorithmInfo;
+struct hashknownalgorithminfo {
+    const char *name;
+    TfuncHashKnownAlgorithm func;
+};
+
+extern const HashKnownAlgorithmInfo hashKnownAlgorithms[];
+extern const int hashKnownAlgorithmsCount;
+
+/**
+ * @brief identifier of each function, same value as its position in "hashKnownAlgorithms"
+ */
+typedef enum hashknownalgorithmid
+{
+    HKA_RS,
+    HKA_JS,
+    HKA_PJW,
+    HKA_ELF,
+    HKA_BKDR,
+    HKA_SDBM,
+    HKA_DJB,
+    HKA_DEK,
+    HKA_AP,
+    HKA_WY,
+    HKA_STRIPE
+} HashKnownAlgorithmId;
+
+/**
+ * @brief state of an incremental (init/update/final) hash, the key may be split in any number of chunks
+ * and the result is always the same as the one-shot function over the whole key
+ */
+typedef struct hashknownstream HashKnownStream;
+struct hashknownstream {
+    HashKnownAlgorithmId algorithm; /**< function being computed. */
+    unsigned long long length;      /**< bytes consumed so far. */
+    unsigned int hash;              /**< state of the byte-at-a-time functions (00..08). */
+    unsigned int a;                 /**< second state variable of RS. */
+    unsigned long long seed;        /**< seed given to WY and STRIPE. */
+    unsigned long long wy[3];       /**< WY: seed, see1 and see2 of the 48 byte loop. */
+    unsigned long long blocks;      /**< WY: 48 byte blocks already consumed. */
+    unsigned long long acc[4];      /**< STRIPE: accumulators. */
+    unsigned int stripes;           /**< STRIPE: stripes already consumed. */
+    unsigned int bufLength;         /**< bytes waiting in "buf". */
+    char buf[48];                   /**< WY/STRIPE: bytes of an incomplete block. */
+    char last16[16];                /**< WY: last 16 bytes of the last block consumed. */
+};
+
+void hashKnownStreamInit(HashKnownStream *st, HashKnownAlgorithmId algorithm);
+void hashKnownStreamInitSeed(HashKnownStream *st, HashKnownAlgorithmId algorithm, unsigned long long seed);
+void hashKnownStreamUpdate(HashKnownStream *st, const char *str, unsigned int length);
+unsigned int hashKnownStreamFinal(const HashKnownStream *st);
+unsigned long long hashKnownStreamFinal64(const HashKnownStream *st);
+
 #endif // INC_14AED2HASH_HASH_KNOWN_ALGORITHMS_H
@@ -14,9 +14,20 @@
 #include <string.h>
 #include <assert.h>
 #include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/random.h>
 #include "hashtable_jc.h"
+#include "bloom_jc.h"
 #include "lib_jc.h"
 
+// comprimento de uma linha que aparece ou desaparece (tabelas do rehash) em htStatsMoveRow
+#define HT_SEM_LINHA ((size_t)-1)
+
+// passagens da amostra na medição do tempo de cada função de hash (conta a mais rápida)
+#define HT_AUTOHASH_ROUNDS 3
+
 int fakeHashFunc(void *d, void *ctx)
 {
     // é sempre zero...
@@ -28,9 +39,9 @@ void fakeHashDestroy(void *d)
     // nadaaa a fazer aquiiii...
 }
 
-int htLengthRow(NodoHashTable *nodo, int *colisoes)
+size_t htLengthRow(NodoHashTable *nodo, unsigned long long *colisoes)
 {
-    int c = 0;
+    size_t c = 0;
     (*colisoes) = 0;
     while (nodo)
     {
@@ -41,20 +52,234 @@ int htLengthRow(NodoHashTable *nodo, int *colisoes)
     return c;
 }
 
+/**
+ * @brief procedimento para somar "n" linhas com "l" nodos ao histograma, que cresce se for preciso (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ * @param l
+ * @param n pode ser negativo
+ */
+void htStatsHistogramAdd(HashTableCFG *ht, size_t l, long long n)
+{
+    if (l >= ht->chainHistogramSize)
+    {
+        size_t size = ht->chainHistogramSize * 2 > l ? ht->chainHistogramSize * 2 : l + 1;
+        ht->chainHistogram = (size_t *)realloc(ht->chainHistogram, size * sizeof(size_t));
+        assert(ht->chainHistogram);
+        memset(ht->chainHistogram + ht->chainHistogramSize, 0, (size - ht->chainHistogramSize) * sizeof(size_t));
+        ht->chainHistogramSize = size;
+    }
+    ht->chainHistogram[l] += (size_t)n;
+}
+
+/**
+ * @brief procedimento para registar que uma linha passou de "de" para "para" nodos (NOTA: é um procedimento interno)
+ * HT_SEM_LINHA indica uma linha que aparece ou desaparece (tabelas do rehash); os comprimentos mudam de um em um,
+ * por isso ajustar "StatsMax"/"StatsMin" ao histograma custa O(1) por operação
+ *
+ * @param ht
+ * @param de
+ * @param para
+ */
+void htStatsMoveRow(HashTableCFG *ht, size_t de, size_t para)
+{
+    if (de != HT_SEM_LINHA)
+        htStatsHistogramAdd(ht, de, -1);
+    if (para != HT_SEM_LINHA)
+    {
+        htStatsHistogramAdd(ht, para, 1);
+        if (para > ht->StatsMax)
+            ht->StatsMax = para;
+        if (para < ht->StatsMin)
+            ht->StatsMin = para;
+    }
+    while (ht->StatsMax > 0 && ht->chainHistogram[ht->StatsMax] == 0)
+        ht->StatsMax--;
+    while (ht->StatsMin < ht->StatsMax && ht->chainHistogram[ht->StatsMin] == 0)
+        ht->StatsMin++;
+    ht->EmptyRow = ht->chainHistogram[0];
+}
+
+/**
+ * @brief procedimento para atualizar "ColisionsMax"/"ColisionsMin" depois de a soma dos contadores de uma linha
+ * passar de "antes" para "depois" (NOTA: é um procedimento interno)
+ * alargar os limites custa O(1); se a linha que estava num dos limites se afastou dele, o novo limite só se conhece
+ * percorrendo as somas das linhas, o que fica marcado em "colisionsDirty" para o próximo htStatsRead
+ *
+ * @param ht
+ * @param antes
+ * @param depois
+ */
+void htStatsColisions(HashTableCFG *ht, unsigned long long antes, unsigned long long depois)
+{
+    if ((antes == ht->ColisionsMax && depois < antes) || (antes == ht->ColisionsMin && depois > antes))
+        ht->colisionsDirty = true;
+    if (depois > ht->ColisionsMax)
+        ht->ColisionsMax = depois;
+    if (depois < ht->ColisionsMin)
+        ht->ColisionsMin = depois;
+}
+
+/**
+ * @brief procedimento para recalcular "ColisionsMax"/"ColisionsMin" a partir das somas guardadas de cada linha,
+ * sem percorrer as listas (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ */
+void htStatsColisionsRecalc(HashTableCFG *ht)
+{
+    bool primeiro = true;
+    for (int t = 0; t < 2; t++)
+    {
+        HashTableRowStats *rows = t == 0 ? ht->rowStats : ht->oldRowStats;
+        // as linhas antigas já migradas deixaram de contar
+        for (size_t i = t == 0 ? 0 : ht->rehashPos; rows && i < (t == 0 ? ht->M : ht->oldM); i++)
+        {
+            if (primeiro || rows[i].count > ht->ColisionsMax)
+                ht->ColisionsMax = rows[i].count;
+            if (primeiro || rows[i].count < ht->ColisionsMin)
+                ht->ColisionsMin = rows[i].count;
+            primeiro = false;
+        }
+    }
+    ht->colisionsDirty = false;
+}
+
+/**
+ * @brief procedimento para atualizar as estatísticas depois de uma linha ganhar (delta = 1) ou perder (delta = -1)
+ * o nodo "nodo" (NOTA: é um procedimento interno) o comprimento e a soma dos contadores da linha estão em "row",
+ * a lista não é percorrida
+ *
+ * @param ht
+ * @param row
+ * @param delta
+ * @param nodo
+ */
+void htStatsRowChanged(HashTableCFG *ht, HashTableRowStats *row, int delta, NodoHashTable *nodo)
+{
+    size_t de = row->length;
+    if (delta > 0)
+    {
+        row->length++;
+        row->count += nodo->count;
+    }
+    else
+    {
+        row->length--;
+        row->count -= nodo->count;
+    }
+    htStatsMoveRow(ht, de, row->length);
+    htStatsColisions(ht, delta > 0 ? row->count - nodo->count : row->count + nodo->count, row->count);
+}
+
+/**
+ * @brief função para reservar um bloco de "nodes" nodos do alocador "slab", ligado antes de "next" (NOTA: é uma função interna)
+ *
+ * @param nodes
+ * @param next
+ * @return NodoHashTableSlab*
+ */
+NodoHashTableSlab *htNewSlabBlock(size_t nodes, NodoHashTableSlab *next)
+{
+    NodoHashTableSlab *slab = (NodoHashTableSlab *)malloc(sizeof(NodoHashTableSlab) + nodes * sizeof(NodoHashTable));
+    assert(slab);
+    slab->used = 0;
+    slab->next = next;
+    return slab;
+}
+
+/**
+ * @brief procedimento para reservar um novo bloco de nodos do alocador "slab" (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ */
+void htNewSlab(HashTableCFG *ht)
+{
+    ht->slabs = htNewSlabBlock(ht->slabBlockNodes, ht->slabs);
+    ht->slabBlocks++;
+}
+
+/**
+ * @brief função para obter um nodo, reaproveitando os nodos libertados por remoções (NOTA: é uma função interna)
+ *
+ * @param ht
+ * @return NodoHashTable*
+ */
+NodoHashTable *htNewNodo(HashTableCFG *ht)
+{
+    NodoHashTable *cell = ht->freeNodes;
+    if (cell)
+    {
+        ht->freeNodes = cell->next;
+        ht->freeNodesCount--;
+        return cell;
+    }
+    if (ht->slabBlockNodes > 0)
+    {
+        if (!ht->slabs || ht->slabs->used == ht->slabBlockNodes)
+            htNewSlab(ht);
+        return &ht->slabs->nodos[ht->slabs->used++];
+    }
+    cell = (NodoHashTable *)malloc(sizeof(NodoHashTable));
+    assert(cell);
+    return cell;
+}
+
+/**
+ * @brief função para reservar um nodo com espaço para a cópia da chave (NOTA: é uma função interna)
+ * os nodos têm dimensões diferentes, por isso não passam pela lista de nodos livres nem pelo alocador "slab"
+ *
+ * @param key
+ * @param length
+ * @return NodoHashTable*
+ */
+NodoHashTable *htNewNodoInline(const void *key, unsigned int length)
+{
+    NodoHashTableInline *cell = (NodoHashTableInline *)malloc(sizeof(NodoHashTableInline) + length + 1);
+    assert(cell);
+    memcpy(cell->key, key, length);
+    cell->key[length] = '\0';
+    return &cell->nodo;
+}
+
+/**
+ * @brief procedimento para guardar um nodo removido na lista de nodos livres da hashtable (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ * @param nodo
+ */
+void htRecycleNodo(HashTableCFG *ht, NodoHashTable *nodo)
+{
+    if (ht->inlineKeys)
+    {
+        free(nodo);
+        return;
+    }
+    nodo->data = NULL;
+    nodo->next = ht->freeNodes;
+    ht->freeNodes = nodo;
+    ht->freeNodesCount++;
+}
+
 /**
  * @brief função para inserir elemento na lista da hashtable
  *
+ * @param ht
  * @param nodo
  * @param data
+ * @param key chave (copiada para o nodo com "inlineKeys")
+ * @param hash hash completo da chave
+ * @param length comprimento da chave
  * @return NodoHashTable*
  */
-NodoHashTable *htHeadInsertNodo(NodoHashTable *nodo, void *data)
+NodoHashTable *htHeadInsertNodo(HashTableCFG *ht, NodoHashTable *nodo, void *data, const void *key, unsigned int hash, unsigned int length)
 {
-    NodoHashTable *cell = (NodoHashTable *)malloc(sizeof(NodoHashTable));
-    assert(cell);
+    NodoHashTable *cell = ht->inlineKeys ? htNewNodoInline(key, length) : htNewNodo(ht);
     cell->next = nodo;
     cell->data = data;
     cell->count = 0;
+    cell->hash = hash;
+    cell->length = length;
     return cell;
 }
 
@@ -63,148 +288,2159 @@ NodoHashTable *htHeadInsertNodo(NodoHashTable *nodo, void *data)
  *
  * @param nodo
  * @param dd
+ * @param freeNodo false quando os nodos pertencem aos blocos do alocador "slab"
  * @return NodoHashTable*
  */
-NodoHashTable *htFreeHashTableRow(NodoHashTable *nodo, TfuncHashTableDestroyData dd)
+NodoHashTable *htFreeHashTableRow(NodoHashTable *nodo, TfuncHashTableDestroyData dd, bool freeNodo)
 {
     NodoHashTable *ptr = nodo;
     while (nodo)
     {
         dd(nodo->data);
         ptr = nodo->next;
-        free(nodo);
+        if (freeNodo)
+            free(nodo);
         nodo = ptr;
     }
     return NULL;
 }
 
 /**
- * @brief função para destruir a hashtable na "vertical"
+ * @brief função que devolve os bytes da chave de um nodo, o comprimento está em "nodo->length"
+ * (NOTA: é uma função interna, partilhada pelos módulos das tabelas)
  *
  * @param ht
- * @return HashTableCFG*
+ * @param nodo
+ * @return const void*
  */
-HashTableCFG *destroyHashTable(HashTableCFG *ht)
+const void *htNodoKey(HashTableCFG *ht, NodoHashTable *nodo)
 {
-    assert(ht);
-    for (int i = 0; i < ht->M; i++)
+    unsigned int l = nodo->length;
+    if (ht->inlineKeys)
+        return ((NodoHashTableInline *)nodo)->key;
+    return ht->getKey ? ht->getKey(nodo->data, &l) : ht->getString(nodo->data);
+}
+
+/**
+ * @brief função para comparar a chave (h, key, length) com a chave de um nodo pela ordem (hash, comprimento, bytes) (NOTA: é uma função interna)
+ *
+ * @param ht
+ * @param h
+ * @param key
+ * @param length
+ * @param nodo
+ * @return int (-1, 0, 1)
+ */
+int htTreeCompare(HashTableCFG *ht, unsigned int h, const void *key, unsigned int length, NodoHashTable *nodo)
+{
+    if (h != nodo->hash)
+        return h < nodo->hash ? -1 : 1;
+    if (length != nodo->length)
+        return length < nodo->length ? -1 : 1;
+    int c = memcmp(key, htNodoKey(ht, nodo), length);
+    return c < 0 ? -1 : c > 0 ? 1 : 0;
+}
+
+// uso interno, não exportar!!!!!
+int htTreeAltura(NodoHashTableTree *t)
+{
+    return t ? t->altura : 0;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeUpdate(NodoHashTableTree *t)
+{
+    int l = htTreeAltura(t->left), r = htTreeAltura(t->right);
+    t->altura = (l > r ? l : r) + 1;
+    return t;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeRotateRight(NodoHashTableTree *t)
+{
+    NodoHashTableTree *l = t->left;
+    t->left = l->right;
+    l->right = htTreeUpdate(t);
+    return htTreeUpdate(l);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeRotateLeft(NodoHashTableTree *t)
+{
+    NodoHashTableTree *r = t->right;
+    t->right = r->left;
+    r->left = htTreeUpdate(t);
+    return htTreeUpdate(r);
+}
+
+/**
+ * @brief função para repor o equilíbrio AVL de uma subárvore depois de uma inserção/remoção (NOTA: é uma função interna)
+ *
+ * @param t
+ * @return NodoHashTableTree* nova raiz da subárvore
+ */
+NodoHashTableTree *htTreeBalance(NodoHashTableTree *t)
+{
+    htTreeUpdate(t);
+    int fb = htTreeAltura(t->left) - htTreeAltura(t->right);
+    if (fb > 1)
     {
-        ht->hashtable[i] = htFreeHashTableRow(ht->hashtable[i], ht->destroy);
+        if (htTreeAltura(t->left->left) < htTreeAltura(t->left->right))
+            t->left = htTreeRotateLeft(t->left);
+        return htTreeRotateRight(t);
+    }
+    if (fb < -1)
+    {
+        if (htTreeAltura(t->right->right) < htTreeAltura(t->right->left))
+            t->right = htTreeRotateRight(t->right);
+        return htTreeRotateLeft(t);
+    }
+    return t;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeInsert(HashTableCFG *ht, NodoHashTableTree *t, NodoHashTable *nodo, const void *key)
+{
+    if (!t)
+    {
+        t = (NodoHashTableTree *)malloc(sizeof(NodoHashTableTree));
+        assert(t);
+        t->nodo = nodo;
+        t->left = t->right = NULL;
+        t->altura = 1;
+        return t;
+    }
+    if (htTreeCompare(ht, nodo->hash, key, nodo->length, t->nodo) < 0)
+        t->left = htTreeInsert(ht, t->left, nodo, key);
+    else
+        t->right = htTreeInsert(ht, t->right, nodo, key);
+    return htTreeBalance(t);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeRemoveMin(NodoHashTableTree *t, NodoHashTableTree **min)
+{
+    if (!t->left)
+    {
+        (*min) = t;
+        return t->right;
+    }
+    t->left = htTreeRemoveMin(t->left, min);
+    return htTreeBalance(t);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableTree *htTreeRemove(HashTableCFG *ht, NodoHashTableTree *t, NodoHashTable *nodo, const void *key)
+{
+    if (!t)
+        return NULL;
+    if (t->nodo != nodo)
+    {
+        if (htTreeCompare(ht, nodo->hash, key, nodo->length, t->nodo) < 0)
+            t->left = htTreeRemove(ht, t->left, nodo, key);
+        else
+            t->right = htTreeRemove(ht, t->right, nodo, key);
+        return htTreeBalance(t);
+    }
+    NodoHashTableTree *l = t->left, *r = t->right;
+    free(t);
+    if (!r)
+        return l;
+    // o sucessor ocupa o lugar do nodo removido
+    NodoHashTableTree *min;
+    r = htTreeRemoveMin(r, &min);
+    min->left = l;
+    min->right = r;
+    return htTreeBalance(min);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTable *htTreeFind(HashTableCFG *ht, NodoHashTableTree *t, const void *key, unsigned int length, unsigned int h, size_t *probes)
+{
+    while (t)
+    {
+        (*probes)++;
+        int c = htTreeCompare(ht, h, key, length, t->nodo);
+        if (c == 0)
+            return t->nodo;
+        t = c < 0 ? t->left : t->right;
     }
-    free(ht);
     return NULL;
 }
 
+// uso interno, não exportar!!!!!
+void htTreeFree(NodoHashTableTree *t)
+{
+    if (!t)
+        return;
+    htTreeFree(t->left);
+    htTreeFree(t->right);
+    free(t);
+}
+
+// uso interno, não exportar!!!!!
+// verifica se a lista tem mais de "n" nodos sem a percorrer toda
+bool htRowLongerThan(NodoHashTable *nodo, int n)
+{
+    for (; nodo; nodo = nodo->next)
+    {
+        if (--n < 0)
+            return true;
+    }
+    return false;
+}
+
+// uso interno, não exportar!!!!!
+// constrói a árvore com todos os nodos da lista "row" (só lê a tabela, pode correr em paralelo noutras linhas)
+NodoHashTableTree *htTreeBuildRow(HashTableCFG *ht, NodoHashTable *row)
+{
+    NodoHashTableTree *t = NULL;
+    for (NodoHashTable *nodo = row; nodo; nodo = nodo->next)
+    {
+        t = htTreeInsert(ht, t, nodo, htNodoKey(ht, nodo));
+    }
+    return t;
+}
+
 /**
- * @brief função para calcular os dados estatisticos
+ * @brief procedimento para criar a árvore da linha "pos" da tabela atual (NOTA: é um procedimento interno)
  *
  * @param ht
+ * @param pos
  */
-void htStatsCalc(HashTableCFG *ht)
+void htTreeifyRow(HashTableCFG *ht, size_t pos)
 {
-    assert(ht);
-    int colisoes = 0;
-    ht->EmptyRow = 0;
-    ht->StatsMax = htLengthRow(ht->hashtable[0], &colisoes);
-    if (ht->StatsMax == 0)
-        ht->EmptyRow++;
-    ht->StatsMin = ht->StatsMax;
-    ht->ColisionsMax = colisoes;
-    ht->ColisionsMin = ht->ColisionsMax;
-    for (int i = 1; i < ht->M; i++)
+    if (!ht->trees)
     {
-        int l = htLengthRow(ht->hashtable[i], &colisoes);
-        if (l == 0)
-            ht->EmptyRow++;
-        if (l > ht->StatsMax)
-            ht->StatsMax = l;
-        if (l < ht->StatsMin)
-            ht->StatsMin = l;
-        if (colisoes > ht->ColisionsMax)
-            ht->ColisionsMax = colisoes;
-        if (colisoes < ht->ColisionsMin)
-            ht->ColisionsMin = colisoes;
+        ht->trees = (NodoHashTableTree **)calloc(ht->M, sizeof(NodoHashTableTree *));
+        assert(ht->trees);
     }
+    ht->trees[pos] = htTreeBuildRow(ht, ht->hashtable[pos]);
+    ht->TreeifiedRows++;
 }
 
-// uso interno, não exportar!!!!!
-bool htExistStringColision(HashTableCFG *ht, char *v, bool registar)
+/**
+ * @brief procedimento para atualizar a árvore depois de "nodo" entrar na linha "pos" da tabela atual,
+ * criando-a se a linha passou a ter mais de HT_TREEIFY_THRESHOLD nodos (NOTA: é um procedimento interno)
+ * as árvores comparam os bytes das chaves, por isso as tabelas com "keyEquals" próprio ficam só com listas
+ *
+ * @param ht
+ * @param pos
+ * @param nodo
+ */
+void htTreeRowAdded(HashTableCFG *ht, size_t pos, NodoHashTable *nodo)
 {
-    NodoHashTable *nodo = ht->hashtable[ht->hash(v, ht)];
-    ht->lastFound = NULL;
-    int cmp = -2; // tem que ser diferente de "0"
-    while (nodo && (cmp = strcmp(ht->getString(nodo->data), v)) != 0)
+    if (ht->trees && ht->trees[pos])
+        ht->trees[pos] = htTreeInsert(ht, ht->trees[pos], nodo, htNodoKey(ht, nodo));
+    else if (ht->treeify && !ht->keyEquals && htRowLongerThan(ht->hashtable[pos], HT_TREEIFY_THRESHOLD))
+        htTreeifyRow(ht, pos);
+}
+
+/**
+ * @brief procedimento para retirar "nodo" da árvore da linha "pos" antes de sair da lista (os dados ainda existem),
+ * desfazendo a árvore se a linha vai ficar com HT_UNTREEIFY_THRESHOLD nodos (NOTA: é um procedimento interno)
+ * serve as duas tabelas: "trees" e "rows" são os arrays da tabela atual ou da tabela antiga
+ *
+ * @param ht
+ * @param trees
+ * @param rows
+ * @param pos
+ * @param nodo
+ */
+void htTreeRowRemoving(HashTableCFG *ht, NodoHashTableTree **trees, NodoHashTable **rows, size_t pos, NodoHashTable *nodo)
+{
+    if (!trees || !trees[pos])
+        return;
+    if (!htRowLongerThan(rows[pos], HT_UNTREEIFY_THRESHOLD + 1))
     {
-        nodo = nodo->next;
+        htTreeFree(trees[pos]);
+        trees[pos] = NULL;
+        ht->TreeifiedRows--;
+        return;
+    }
+    trees[pos] = htTreeRemove(ht, trees[pos], nodo, htNodoKey(ht, nodo));
+}
+
+/**
+ * @brief procedimento para libertar todas as árvores, da tabela atual e das linhas da tabela antiga
+ * ainda por migrar (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ */
+void htTreeFreeAll(HashTableCFG *ht)
+{
+    for (size_t i = 0; ht->trees && i < ht->M; i++)
+    {
+        htTreeFree(ht->trees[i]);
     }
-    if (nodo && cmp == 0)
+    free(ht->trees);
+    ht->trees = NULL;
+    for (size_t i = ht->rehashPos; ht->oldTrees && i < ht->oldM; i++)
     {
-        ht->lastFound = nodo;
-        if (registar)
-            nodo->count++;
+        htTreeFree(ht->oldTrees[i]);
     }
-    return nodo ? true : false;
+    free(ht->oldTrees);
+    ht->oldTrees = NULL;
+    ht->TreeifiedRows = 0;
 }
 
 /**
- * @brief função para inserir dados na hashtable
+ * @brief função para destruir a hashtable na "vertical"
  *
  * @param ht
- * @param data
- * @return true
- * @return false
+ * @return HashTableCFG*
  */
-bool htInsertData(HashTableCFG *ht, void *data)
+HashTableCFG *destroyHashTable(HashTableCFG *ht)
 {
     assert(ht);
-    assert(ht->hash);
-    char *tmpstr = ht->getString(data);
-    if (!htExistStringColision(ht, tmpstr, true))
+    for (size_t i = 0; i < ht->M; i++)
     {
-        int pos = ht->hash(ht->getString(data), ht);
-        ht->hashtable[pos] = htHeadInsertNodo(ht->hashtable[pos], data);
-        ht->nextDataID++;
-        return true;
+        ht->hashtable[i] = htFreeHashTableRow(ht->hashtable[i], ht->destroy, ht->slabBlockNodes == 0);
     }
-    return false;
+    if (ht->oldHashtable)
+    {
+        // rehash incompleto, ainda há linhas por migrar na tabela antiga
+        for (size_t i = ht->rehashPos; i < ht->oldM; i++)
+        {
+            ht->oldHashtable[i] = htFreeHashTableRow(ht->oldHashtable[i], ht->destroy, ht->slabBlockNodes == 0);
+        }
+        free(ht->oldHashtable);
+    }
+    while (ht->freeNodes && ht->slabBlockNodes == 0)
+    {
+        NodoHashTable *ptr = ht->freeNodes->next;
+        free(ht->freeNodes);
+        ht->freeNodes = ptr;
+    }
+    // com o alocador "slab" todos os nodos são libertados bloco a bloco
+    while (ht->slabs)
+    {
+        NodoHashTableSlab *ptr = ht->slabs->next;
+        free(ht->slabs);
+        ht->slabs = ptr;
+    }
+    if (ht->bloom)
+        destroyBloomFilter(ht->bloom);
+    htTreeFreeAll(ht);
+    free(ht->chainHistogram);
+    free(ht->rowStats);
+    free(ht->oldRowStats);
+    free(ht->hashtable);
+    free(ht);
+    return NULL;
 }
 
 /**
- * @brief função para verificar se existe uma string na hashtable
+ * @brief função de mistura final (fmix32 do MurmurHash3) (NOTA: é uma função interna, partilhada pelos módulos das tabelas)
+ * com M potência de 2 só alguns bits do hash escolhem a linha, e as funções mais simples de
+ * "hash_known_algorithms.c" (ex: DJB, SDBM) deixam esses bits mal distribuídos
  *
- * @param ht
- * @param v
- * @return true
- * @return false
+ * @param h
+ * @return unsigned int
  */
-bool htExistString(HashTableCFG *ht, char *v)
+unsigned int htMix(unsigned int h)
 {
-    assert(ht);
-    assert(ht->hash);
-    return htExistStringColision(ht, v, false);
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
 }
 
 /**
- * @brief função para inicializar uma hashtable
+ * @brief função que devolve a linha do hash completo "h" numa tabela com "m" linhas dimensionada com "sizing"
+ * (também usada pelos ficheiros "snapshot", que guardam o dimensionamento da tabela)
  *
- * @param m
- * @param fh
- * @param dd
- * @param gs
- * @return HashTableCFG*
+ * @param sizing
+ * @param h
+ * @param m até HT_MAX_M
+ * @return size_t
  */
-HashTableCFG *newHashTable(int m, TfuncHashTableHashFunc fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+size_t htSizingBucket(HashTableSizing sizing, unsigned int h, size_t m)
 {
-    HashTableCFG *novo = (HashTableCFG *)malloc(sizeof(HashTableCFG));
-    assert(novo);
-    novo->M = getNearestPrimeNumber(m); // procura o número primo mais próximo para reduzir o número de colisões na HT
-    novo->StatsMax = novo->StatsMin = novo->ColisionsMax = novo->ColisionsMin = novo->EmptyRow = 0;
+    switch (sizing)
+    {
+    case HT_SIZING_POW2_MASK:
+        return (size_t)htMix(h) & (m - 1);
+    case HT_SIZING_POW2_FASTRANGE:
+        // multiplicação em vez de divisão, usa os bits mais altos do hash misturado
+        return (size_t)(((unsigned long long)htMix(h) * m) >> 32);
+    default:
+        return (size_t)h % m;
+    }
+}
+
+// uso interno, não exportar!!!!!
+size_t htBucket(HashTableCFG *ht, unsigned int h, size_t m)
+{
+    return htSizingBucket(ht->sizing, h, m);
+}
+
+/**
+ * @brief função que devolve a dimensão da tabela para (pelo menos) "m" linhas: o primo seguinte da tabela
+ * "hashTablePrimes" (sem testar primos) ou a potência de 2 seguinte, nunca acima de HT_MAX_M (NOTA: é uma função interna)
+ *
+ * @param ht
+ * @param m
+ * @return size_t
+ */
+size_t htTableSize(HashTableCFG *ht, size_t m)
+{
+    if (m > HT_MAX_M)
+        m = HT_MAX_M;
+    if (ht->sizing == HT_SIZING_PRIME)
+    {
+        unsigned long long p = getHashTablePrime(m);
+        // o primo seguinte pode passar o limite, nesse caso fica o anterior da tabela
+        for (int i = hashTablePrimesCount - 1; p > HT_MAX_M; i--)
+            p = hashTablePrimes[i];
+        return (size_t)p;
+    }
+    size_t p = 1;
+    while (p < m)
+        p <<= 1;
+    return p;
+}
+
+/**
+ * @brief função que devolve a dimensão pedida na criação da tabela: o primo mais próximo (>= m) ou a potência de 2
+ * seguinte, nunca acima de HT_MAX_M; só os crescimentos e encolhimentos seguem "hashTablePrimes" (NOTA: é uma função interna)
+ *
+ * @param ht
+ * @param m
+ * @return size_t
+ */
+size_t htTableSizeInitial(HashTableCFG *ht, size_t m)
+{
+    if (ht->sizing != HT_SIZING_PRIME || m >= HT_MAX_M)
+        return htTableSize(ht, m);
+    unsigned long long p = getNearestPrimeNumber64(m);
+    return p > HT_MAX_M ? htTableSize(ht, m) : (size_t)p;
+}
+
+/**
+ * @brief função que devolve a dimensão seguinte da tabela acima de "m": o primo seguinte de "hashTablePrimes" ou
+ * o dobro, nunca acima de HT_MAX_M (devolve "m" no limite) (NOTA: é uma função interna)
+ * os primos da tabela não são exatamente o dobro do anterior, por isso htTableSize(2 * m) pode saltar um primo
+ *
+ * @param ht
+ * @param m
+ * @return size_t
+ */
+size_t htTableSizeAbove(HashTableCFG *ht, size_t m)
+{
+    if (ht->sizing != HT_SIZING_PRIME)
+        return m < HT_MAX_M ? htTableSize(ht, m + 1) : m;
+    int i = 0;
+    while (i < hashTablePrimesCount && hashTablePrimes[i] <= m)
+        i++;
+    if (i == hashTablePrimesCount || hashTablePrimes[i] > HT_MAX_M)
+        return m;
+    return (size_t)hashTablePrimes[i];
+}
+
+/**
+ * @brief função que devolve a maior dimensão da tabela abaixo de "m" (NOTA: é uma função interna)
+ * os primos da tabela crescem um pouco mais do que o dobro, por isso htTableSize(m / 2) pode voltar a dar "m"
+ *
+ * @param ht
+ * @param m
+ * @return size_t
+ */
+size_t htTableSizeBelow(HashTableCFG *ht, size_t m)
+{
+    if (ht->sizing != HT_SIZING_PRIME)
+        return m / 2;
+    int i = hashTablePrimesCount - 1;
+    while (i >= 0 && hashTablePrimes[i] >= m)
+        i--;
+    // abaixo do primeiro primo da tabela só resta a dimensão inicial (quem chama limita o resultado por "initialM")
+    return i < 0 ? 0 : (size_t)hashTablePrimes[i];
+}
+
+/**
+ * @brief função para reservar as linhas (vazias) de uma tabela com "m" posições (NOTA: é uma função interna)
+ *
+ * @param m
+ * @return NodoHashTable**
+ */
+NodoHashTable **htNewRows(size_t m)
+{
+    NodoHashTable **rows = (NodoHashTable **)calloc(m, sizeof(NodoHashTable *));
+    assert(rows);
+    return rows;
+}
+
+/**
+ * @brief função para calcular a posição de "v" numa tabela com "m" linhas (NOTA: é uma função interna)
+ * a função de hash recebe a hashtable como contexto e usa "M" para calcular a posição,
+ * por isso durante o rehash é necessário apresentar-lhe temporariamente a dimensão da tabela antiga
+ *
+ * @param ht
+ * @param v
+ * @param m
+ * @return size_t
+ */
+size_t htPosicao(HashTableCFG *ht, char *v, size_t m)
+{
+    size_t tmp = ht->M;
+    ht->M = m;
+    size_t pos = (size_t)ht->hash(v, ht);
+    ht->M = tmp;
+    return pos;
+}
+
+/**
+ * @brief procedimento para migrar até "n" linhas da tabela antiga para a tabela nova (NOTA: é um procedimento interno)
+ * os nodos são reaproveitados, apenas mudam de lista, portanto "lastFound" continua válido
+ *
+ * @param ht
+ * @param n
+ */
+void htRehashStep(HashTableCFG *ht, size_t n)
+{
+    // limitar também as linhas vazias visitadas para que nenhuma operação pague a tabela inteira
+    size_t vazias = n * 10;
+    while (n > 0 && vazias > 0 && ht->rehashPos < ht->oldM)
+    {
+        NodoHashTable *nodo = ht->oldHashtable[ht->rehashPos];
+        if (ht->statsTracking)
+        {
+            // a linha antiga deixa de contar, cada nodo conta na linha nova onde cai
+            HashTableRowStats *old = ht->oldRowStats + ht->rehashPos;
+            htStatsMoveRow(ht, old->length, HT_SEM_LINHA);
+            if (old->count == ht->ColisionsMax || old->count == ht->ColisionsMin)
+                ht->colisionsDirty = true;
+        }
+        if (!nodo)
+        {
+            vazias--;
+        }
+        else
+        {
+            // a árvore da linha antiga deixa de ser precisa, as linhas novas criam as suas se ficarem longas
+            if (ht->oldTrees && ht->oldTrees[ht->rehashPos])
+            {
+                htTreeFree(ht->oldTrees[ht->rehashPos]);
+                ht->oldTrees[ht->rehashPos] = NULL;
+                ht->TreeifiedRows--;
+            }
+            while (nodo)
+            {
+                NodoHashTable *ptr = nodo->next;
+                // com o hash completo guardado no nodo não é preciso voltar aos dados do utilizador
+                size_t pos = ht->hashKey ? htBucket(ht, nodo->hash, ht->M)
+                                         : (size_t)ht->hash(ht->inlineKeys ? ((NodoHashTableInline *)nodo)->key : ht->getString(nodo->data), ht);
+                nodo->next = ht->hashtable[pos];
+                ht->hashtable[pos] = nodo;
+                if (ht->statsTracking)
+                    htStatsRowChanged(ht, ht->rowStats + pos, 1, nodo);
+                htTreeRowAdded(ht, pos, nodo);
+                nodo = ptr;
+            }
+            ht->oldHashtable[ht->rehashPos] = NULL;
+            n--;
+        }
+        ht->rehashPos++;
+    }
+    if (ht->rehashPos >= ht->oldM)
+    {
+        // terminou o rehash
+        free(ht->oldHashtable);
+        ht->oldHashtable = NULL;
+        free(ht->oldRowStats);
+        ht->oldRowStats = NULL;
+        free(ht->oldTrees);
+        ht->oldTrees = NULL;
+        ht->oldM = 0;
+        ht->rehashPos = 0;
+    }
+}
+
+/**
+ * @brief procedimento para iniciar o rehash incremental para uma tabela com "m" linhas, já calculadas com
+ * htTableSize/htTableSizeAbove/htTableSizeBelow (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ * @param m
+ */
+void htStartRehash(HashTableCFG *ht, size_t m)
+{
+    if (ht->oldHashtable)
+        htRehashAll(ht);
+    // as linhas longas da tabela antiga continuam a ser pesquisadas na sua árvore até serem migradas,
+    // as linhas da tabela nova criam as suas à medida que recebem nodos
+    ht->oldTrees = ht->trees;
+    ht->trees = NULL;
+    ht->oldHashtable = ht->hashtable;
+    ht->oldM = ht->M;
+    ht->rehashPos = 0;
+    ht->M = m;
+    ht->hashtable = htNewRows(ht->M);
+    if (ht->statsTracking)
+    {
+        // durante o rehash as estatísticas contam as linhas das duas tabelas
+        ht->oldRowStats = ht->rowStats;
+        ht->rowStats = (HashTableRowStats *)calloc(ht->M, sizeof(HashTableRowStats));
+        assert(ht->rowStats);
+        htStatsHistogramAdd(ht, 0, (long long)ht->M);
+        htStatsMoveRow(ht, HT_SEM_LINHA, HT_SEM_LINHA);
+        ht->StatsMin = 0;
+        ht->ColisionsMin = 0;
+    }
+}
+
+/**
+ * @brief procedimento para atualizar o fator de carga e, se necessário, iniciar o crescimento/encolhimento da tabela (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ */
+void htCheckLoadFactor(HashTableCFG *ht)
+{
+    ht->loadFactor = (float)ht->totalItems / (float)ht->M;
+    // só se inicia um novo rehash depois de terminar o anterior
+    if (ht->oldHashtable)
+        return;
+    if (ht->loadFactorMax > 0 && ht->loadFactor > ht->loadFactorMax)
+    {
+        // no limite a tabela deixa de crescer (as linhas longas passam a árvores)
+        size_t m = htTableSizeAbove(ht, ht->M);
+        if (m <= ht->M)
+            return;
+        htStartRehash(ht, m);
+    }
+    else if (ht->loadFactorMin > 0 && ht->loadFactor < ht->loadFactorMin && ht->M > ht->initialM)
+    {
+        size_t m = htTableSizeBelow(ht, ht->M);
+        htStartRehash(ht, m < ht->initialM ? ht->initialM : m);
+    }
+    else
+    {
+        return;
+    }
+    ht->loadFactor = (float)ht->totalItems / (float)ht->M;
+}
+
+/**
+ * @brief procedimento para terminar de imediato um rehash incremental que esteja em curso
+ *
+ * @param ht
+ */
+void htRehashAll(HashTableCFG *ht)
+{
+    assert(ht);
+    while (ht->oldHashtable)
+    {
+        htRehashStep(ht, ht->oldM);
+    }
+}
+
+/**
+ * @brief função para verificar se a hashtable está a meio de um rehash incremental
+ *
+ * @param ht
+ * @return true
+ * @return false
+ */
+bool htIsRehashing(HashTableCFG *ht)
+{
+    assert(ht);
+    return ht->oldHashtable ? true : false;
+}
+
+/**
+ * @brief procedimento para ligar o alocador "slab": os nodos passam a ser entregues a partir de blocos
+ * contíguos com "nodesPerBlock" nodos e são libertados bloco a bloco em "destroyHashTable"
+ * NOTA: só pode ser ligado antes da primeira inserção
+ *
+ * @param ht
+ * @param nodesPerBlock
+ */
+void htSetSlabAllocator(HashTableCFG *ht, size_t nodesPerBlock)
+{
+    assert(ht);
+    assert(ht->totalItems == 0 && ht->freeNodesCount == 0 && ht->slabBlockNodes == 0);
+    assert(!ht->inlineKeys);
+    assert(nodesPerBlock > 0);
+    ht->slabBlockNodes = nodesPerBlock;
+}
+
+/**
+ * @brief procedimento para ligar/desligar a conversão das linhas longas em árvores AVL (ligada por omissão):
+ * uma linha com mais de HT_TREEIFY_THRESHOLD nodos passa a ser pesquisada em O(log n), mesmo com uma função
+ * de hash fraca ou chaves escolhidas para colidir; ao ligar, as linhas longas que já existem são convertidas
+ *
+ * @param ht
+ * @param on
+ */
+void htSetTreeify(HashTableCFG *ht, bool on)
+{
+    assert(ht);
+    htTreeFreeAll(ht);
+    ht->treeify = on;
+    for (size_t i = 0; on && i < ht->M; i++)
+    {
+        if (!ht->keyEquals && htRowLongerThan(ht->hashtable[i], HT_TREEIFY_THRESHOLD))
+            htTreeifyRow(ht, i);
+    }
+    // durante um rehash as linhas da tabela antiga ainda por migrar também são convertidas
+    for (size_t i = ht->rehashPos; on && ht->oldHashtable && i < ht->oldM; i++)
+    {
+        if (!ht->keyEquals && htRowLongerThan(ht->oldHashtable[i], HT_TREEIFY_THRESHOLD))
+        {
+            if (!ht->oldTrees)
+            {
+                ht->oldTrees = (NodoHashTableTree **)calloc(ht->oldM, sizeof(NodoHashTableTree *));
+                assert(ht->oldTrees);
+            }
+            ht->oldTrees[i] = htTreeBuildRow(ht, ht->oldHashtable[i]);
+            ht->TreeifiedRows++;
+        }
+    }
+}
+
+/**
+ * @brief procedimento para usar uma semente própria no hash das chaves, para que não seja possível escolher
+ * chaves que caiam todas na mesma linha: o hash passa a ser o WYHash64 com a semente (dobrado para 32 bits)
+ * em vez de "hashKey", porque as funções byte a byte não têm semente e as suas colisões não dependem dela
+ * NOTA: só pode ser escolhida antes da primeira inserção e só em tabelas com função de hash completa
+ *
+ * @param ht
+ * @param seed semente a usar, 0 = semente aleatória do sistema operativo
+ */
+void htSetHashSeed(HashTableCFG *ht, unsigned long long seed)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(ht->totalItems == 0 && !ht->oldHashtable);
+    if (seed == 0 && getrandom(&seed, sizeof(seed), 0) != (ssize_t)sizeof(seed))
+        seed = (unsigned long long)time(NULL) ^ (unsigned long long)(size_t)ht;
+    ht->hashSeed = seed ? seed : 1;
+}
+
+/**
+ * @brief procedimento para escolher o dimensionamento da tabela: M primo com "%" (por omissão) ou M potência de 2
+ * com máscara/redução de Lemire sobre o hash misturado (htMix), que evitam a divisão em cada pesquisa;
+ * a tabela é refeita com a nova dimensão
+ * NOTA: só pode ser escolhido antes da primeira inserção e só em tabelas com função de hash completa
+ *
+ * @param ht
+ * @param sizing
+ */
+void htSetSizing(HashTableCFG *ht, HashTableSizing sizing)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(ht->totalItems == 0 && !ht->oldHashtable);
+    ht->sizing = sizing;
+    free(ht->hashtable);
+    ht->M = ht->initialM = htTableSizeInitial(ht, ht->M);
+    ht->hashtable = htNewRows(ht->M);
+    if (ht->statsTracking)
+        htSetStatsTracking(ht, true);
+    htCheckLoadFactor(ht);
+}
+
+/**
+ * @brief procedimento para ligar a cópia das chaves para dentro dos nodos (NodoHashTableInline):
+ * as comparações das pesquisas leem só o nodo em vez de "nodo->data" -> "getString" -> string,
+ * à custa de memória extra por chave (comprimento + 1 bytes) e de um malloc por nodo
+ * NOTA: só pode ser ligado antes da primeira inserção e não é compatível com o alocador "slab"
+ *
+ * @param ht
+ */
+void htSetInlineKeys(HashTableCFG *ht)
+{
+    assert(ht);
+    assert(ht->totalItems == 0 && ht->freeNodesCount == 0 && ht->slabBlockNodes == 0);
+    ht->inlineKeys = true;
+}
+
+/**
+ * @brief procedimento para configurar o fator de carga alvo (crescer) e o mínimo (encolher)
+ * um valor igual a zero desliga o respetivo redimensionamento automático
+ * NOTA: nas tabelas criadas com "newHashTable" o redimensionamento vem desligado; ao ligá-lo, a função de hash
+ * tem de calcular a posição com "M" da própria tabela (é chamada com "M" igual à dimensão da tabela a pesquisar)
+ *
+ * @param ht
+ * @param max
+ * @param min
+ */
+void htSetLoadFactor(HashTableCFG *ht, float max, float min)
+{
+    assert(ht);
+    assert(max <= 0 || min < max / 2); // evitar que cresça e encolha alternadamente
+    ht->loadFactorMax = max;
+    ht->loadFactorMin = min;
+    htCheckLoadFactor(ht);
+}
+
+/**
+ * @brief função para calcular os dados estatisticos
+ *
+ * @param ht
+ */
+void htStatsCalc(HashTableCFG *ht)
+{
+    assert(ht);
+    // as estatísticas só fazem sentido com todos os dados na mesma tabela
+    htRehashAll(ht);
+    unsigned long long colisoes = 0;
+    if (ht->statsTracking)
+        memset(ht->chainHistogram, 0, ht->chainHistogramSize * sizeof(size_t));
+    ht->EmptyRow = 0;
+    ht->StatsMax = htLengthRow(ht->hashtable[0], &colisoes);
+    if (ht->statsTracking)
+    {
+        htStatsHistogramAdd(ht, ht->StatsMax, 1);
+        ht->rowStats[0].length = ht->StatsMax;
+        ht->rowStats[0].count = colisoes;
+    }
+    if (ht->StatsMax == 0)
+        ht->EmptyRow++;
+    ht->StatsMin = ht->StatsMax;
+    ht->ColisionsMax = colisoes;
+    ht->ColisionsMin = ht->ColisionsMax;
+    ht->colisionsDirty = false;
+    for (size_t i = 1; i < ht->M; i++)
+    {
+        size_t l = htLengthRow(ht->hashtable[i], &colisoes);
+        if (ht->statsTracking)
+        {
+            htStatsHistogramAdd(ht, l, 1);
+            ht->rowStats[i].length = l;
+            ht->rowStats[i].count = colisoes;
+        }
+        if (l == 0)
+            ht->EmptyRow++;
+        if (l > ht->StatsMax)
+            ht->StatsMax = l;
+        if (l < ht->StatsMin)
+            ht->StatsMin = l;
+        if (colisoes > ht->ColisionsMax)
+            ht->ColisionsMax = colisoes;
+        if (colisoes < ht->ColisionsMin)
+            ht->ColisionsMin = colisoes;
+    }
+    ht->TreeifiedRows = 0;
+    for (size_t i = 0; ht->trees && i < ht->M; i++)
+    {
+        if (ht->trees[i])
+            ht->TreeifiedRows++;
+    }
+    for (size_t i = ht->rehashPos; ht->oldTrees && i < ht->oldM; i++)
+    {
+        if (ht->oldTrees[i])
+            ht->TreeifiedRows++;
+    }
+}
+
+/**
+ * @brief procedimento para ligar/desligar a manutenção das estatísticas em cada inserção/remoção:
+ * StatsMax, StatsMin, EmptyRow, ColisionsMax/Min (ver htStatsColisions), o histograma dos comprimentos
+ * das listas e os nodos visitados pelas pesquisas com e sem sucesso (as inserções também pesquisam).
+ * Ao ligar é feita uma passagem completa (htStatsCalc), depois cada operação atualiza o comprimento e a soma
+ * dos contadores da linha alterada (HashTableRowStats) em O(1), sem percorrer a lista.
+ *
+ * @param ht
+ * @param on
+ */
+void htSetStatsTracking(HashTableCFG *ht, bool on)
+{
+    assert(ht);
+    // o rehash em curso termina antes de ligar, as estatísticas de cada linha só existem para a tabela atual
+    htRehashAll(ht);
+    free(ht->chainHistogram);
+    ht->chainHistogram = NULL;
+    ht->chainHistogramSize = 0;
+    free(ht->rowStats);
+    ht->rowStats = NULL;
+    ht->lastFoundRow = NULL;
+    ht->lookupsHit = ht->probesHit = ht->lookupsMiss = ht->probesMiss = 0;
+    ht->statsTracking = on;
+    if (on)
+    {
+        ht->rowStats = (HashTableRowStats *)calloc(ht->M, sizeof(HashTableRowStats));
+        assert(ht->rowStats);
+        htStatsHistogramAdd(ht, 0, 0);
+        htStatsCalc(ht);
+    }
+}
+
+/**
+ * @brief procedimento para copiar as estatísticas em O(1), sem percorrer a tabela
+ * (sem "statsTracking" devolve os valores do último htStatsCalc e não tem histograma);
+ * a exceção é "ColisionsMax"/"ColisionsMin" depois de a linha de um dos limites se afastar dele
+ * (remoções, rehash): são recalculados a partir das somas guardadas de cada linha (ver htStatsColisions)
+ *
+ * @param ht
+ * @param stats
+ */
+void htStatsRead(HashTableCFG *ht, HashTableStats *stats)
+{
+    assert(ht);
+    assert(stats);
+    if (ht->statsTracking && ht->colisionsDirty)
+        htStatsColisionsRecalc(ht);
+    stats->M = ht->M;
+    stats->totalItems = ht->totalItems;
+    stats->StatsMax = ht->StatsMax;
+    stats->StatsMin = ht->StatsMin;
+    stats->EmptyRow = ht->EmptyRow;
+    stats->ColisionsMax = ht->ColisionsMax;
+    stats->ColisionsMin = ht->ColisionsMin;
+    stats->loadFactor = (float)ht->totalItems / (float)ht->M;
+    stats->avgProbeHit = ht->lookupsHit ? (double)ht->probesHit / (double)ht->lookupsHit : 0;
+    stats->avgProbeMiss = ht->lookupsMiss ? (double)ht->probesMiss / (double)ht->lookupsMiss : 0;
+    stats->chainHistogram = ht->statsTracking ? ht->chainHistogram : NULL;
+    stats->chainHistogramSize = ht->statsTracking ? ht->StatsMax + 1 : 0;
+    stats->treeifiedRows = ht->TreeifiedRows;
+}
+
+/**
+ * @brief função que devolve a chave dos dados com "getKey" (chave binária) ou, sem ela, com "getString"
+ * (NOTA: é uma função interna, partilhada pelos módulos das tabelas)
+ *
+ * @param gk
+ * @param gs
+ * @param data
+ * @param length devolve o comprimento da chave
+ * @return const void*
+ */
+const void *htKeyOf(TfuncHashTableGetKey gk, TfuncHashTableGetString gs, void *data, unsigned int *length)
+{
+    if (gk)
+        return gk(data, length);
+    char *s = gs(data);
+    (*length) = (unsigned int)strlen(s);
+    return s;
+}
+
+/**
+ * @brief função que devolve a chave dos dados da hashtable (NOTA: é uma função interna, partilhada pelos módulos das tabelas)
+ *
+ * @param ht
+ * @param data
+ * @param length devolve o comprimento da chave
+ * @return const void*
+ */
+const void *htDataKey(HashTableCFG *ht, void *data, unsigned int *length)
+{
+    return htKeyOf(ht->getKey, ht->getString, data, length);
+}
+
+// uso interno, não exportar!!!!!
+bool htNodoKeyEquals(HashTableCFG *ht, NodoHashTable *nodo, const void *key, unsigned int length)
+{
+    unsigned int l = nodo->length;
+    const void *k = ht->inlineKeys ? ((NodoHashTableInline *)nodo)->key
+                  : ht->getKey ? ht->getKey(nodo->data, &l) : ht->getString(nodo->data);
+    if (ht->keyEquals)
+        return ht->keyEquals(k, l, key, length);
+    return memcmp(k, key, length) == 0;
+}
+
+// uso interno, não exportar!!!!!
+unsigned int htHashKey(HashTableCFG *ht, const void *key, unsigned int length, size_t *pos)
+{
+    if (ht->hashKey)
+    {
+        unsigned int h;
+        if (ht->hashSeed)
+        {
+            unsigned long long x = WYHash64Seed((const char *)key, length, ht->hashSeed);
+            h = (unsigned int)(x ^ (x >> 32));
+        }
+        else
+        {
+            h = ht->hashKey((const char *)key, length);
+        }
+        (*pos) = htBucket(ht, h, ht->M);
+        return h;
+    }
+    // a função de hash antiga só devolve a posição, o hash completo fica a zero
+    (*pos) = (size_t)ht->hash((void *)key, ht);
+    return 0;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTable *htFindKeyRow(HashTableCFG *ht, NodoHashTable *nodo, const void *key, unsigned int length, unsigned int h, size_t *probes)
+{
+    // comparar primeiro os inteiros guardados no nodo, só depois os dados do utilizador
+    while (nodo && (nodo->hash != h || nodo->length != length || !htNodoKeyEquals(ht, nodo, key, length)))
+    {
+        (*probes)++;
+        nodo = nodo->next;
+    }
+    if (nodo)
+        (*probes)++;
+    return nodo;
+}
+
+// uso interno, não exportar!!!!!
+unsigned long long htBloomHash(const void *key, unsigned int length)
+{
+    // hash independente do hash da tabela (que pode ser apenas a posição, com a função de hash antiga)
+    return WYHash64((const char *)key, length);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTable *htFindKeyHashed(HashTableCFG *ht, const void *key, unsigned int length, unsigned int h, size_t pos)
+{
+    if (ht->bloom && !bloomMayContain(ht->bloom, htBloomHash(key, length)))
+    {
+        // o filtro garante que a chave não existe, não é preciso percorrer a lista
+        ht->BloomSaved++;
+        if (ht->statsTracking)
+            ht->lookupsMiss++;
+        return NULL;
+    }
+    size_t probes = 0;
+    NodoHashTable *nodo = ht->trees && ht->trees[pos] ? htTreeFind(ht, ht->trees[pos], key, length, h, &probes)
+                                                      : htFindKeyRow(ht, ht->hashtable[pos], key, length, h, &probes);
+    HashTableRowStats *row = ht->rowStats ? ht->rowStats + pos : NULL;
+    if (!nodo && ht->oldHashtable)
+    {
+        // as linhas já migradas estão vazias na tabela antiga
+        size_t oldPos = ht->hashKey ? htBucket(ht, h, ht->oldM) : htPosicao(ht, (char *)key, ht->oldM);
+        nodo = ht->oldTrees && ht->oldTrees[oldPos] ? htTreeFind(ht, ht->oldTrees[oldPos], key, length, h, &probes)
+                                                    : htFindKeyRow(ht, ht->oldHashtable[oldPos], key, length, h, &probes);
+        row = ht->oldRowStats ? ht->oldRowStats + oldPos : NULL;
+    }
+    if (!nodo && ht->bloom)
+        ht->BloomFalsePositives++;
+    if (ht->statsTracking)
+    {
+        if (nodo)
+        {
+            ht->lastFoundRow = row;
+            ht->lookupsHit++;
+            ht->probesHit += probes;
+        }
+        else
+        {
+            ht->lookupsMiss++;
+            ht->probesMiss += probes;
+        }
+    }
+    return nodo;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTable *htFindKey(HashTableCFG *ht, const void *key, unsigned int length, unsigned int *h, size_t *pos)
+{
+    if (ht->oldHashtable)
+        htRehashStep(ht, HT_REHASH_STEP);
+    (*h) = htHashKey(ht, key, length, pos);
+    return htFindKeyHashed(ht, key, length, *h, *pos);
+}
+
+// uso interno, não exportar!!!!!
+double htNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief procedimento para avaliar a função de hash "fh" sobre a amostra: tempo por chave (melhor de
+ * HT_AUTOHASH_ROUNDS passagens) e distribuição das chaves por "m" linhas com o dimensionamento da tabela
+ * (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ * @param fh
+ * @param keys
+ * @param lengths
+ * @param n
+ * @param m
+ * @param counts array com "m" posições, usado para contar as chaves de cada linha
+ * @param r
+ */
+void htEvalHashKey(HashTableCFG *ht, TfuncHashKnownAlgorithm fh, const void **keys, const unsigned int *lengths, size_t n,
+                   size_t m, size_t *counts, HashTableHashReport *r)
+{
+    volatile unsigned int sink = 0;
+    double best = 0;
+    for (int round = 0; round < HT_AUTOHASH_ROUNDS; round++)
+    {
+        unsigned int acc = 0;
+        double t0 = htNowNs();
+        for (size_t i = 0; i < n; i++)
+        {
+            acc ^= fh((const char *)keys[i], lengths[i]);
+        }
+        double t = htNowNs() - t0;
+        sink ^= acc;
+        if (round == 0 || t < best)
+            best = t;
+    }
+    (void)sink;
+
+    memset(counts, 0, m * sizeof(size_t));
+    for (size_t i = 0; i < n; i++)
+    {
+        counts[htSizingBucket(ht->sizing, fh((const char *)keys[i], lengths[i]), m)]++;
+    }
+    double lambda = (double)n / (double)m, quadrados = 0, visitas = 0;
+    r->maxChain = 0;
+    for (size_t i = 0; i < m; i++)
+    {
+        double c = (double)counts[i];
+        quadrados += c * c;
+        // pesquisar cada uma das "c" chaves da linha visita em média (c + 1) / 2 nodos
+        visitas += c * (c + 1) / 2;
+        if (counts[i] > r->maxChain)
+            r->maxChain = counts[i];
+    }
+    r->sampleSize = n;
+    r->M = m;
+    r->nsPerKey = best / (double)n;
+    r->varianceRatio = (quadrados / (double)m - lambda * lambda) / lambda;
+    r->avgProbes = visitas / (double)n;
+}
+
+/**
+ * @brief procedimento para recalcular o hash e a linha de todos os nodos depois de mudar "hashKey" (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ */
+void htRehashKeys(HashTableCFG *ht)
+{
+    htRehashAll(ht);
+    htTreeFreeAll(ht);
+    NodoHashTable **rows = ht->hashtable;
+    ht->hashtable = htNewRows(ht->M);
+    for (size_t i = 0; i < ht->M; i++)
+    {
+        NodoHashTable *nodo = rows[i];
+        while (nodo)
+        {
+            NodoHashTable *ptr = nodo->next;
+            size_t pos;
+            nodo->hash = htHashKey(ht, htNodoKey(ht, nodo), nodo->length, &pos);
+            nodo->next = ht->hashtable[pos];
+            ht->hashtable[pos] = nodo;
+            nodo = ptr;
+        }
+    }
+    free(rows);
+    htSetTreeify(ht, ht->treeify);
+    if (ht->statsTracking)
+        htStatsCalc(ht);
+}
+
+/**
+ * @brief função para escolher a função de hash da tabela a partir de uma amostra de chaves: cada função de
+ * "hashKnownAlgorithms" é avaliada na velocidade e na distribuição das chaves pelas linhas que a tabela teria
+ * para a amostra; entre as bem distribuídas (variância até HT_AUTOHASH_SLACK acima da melhor e de um hash
+ * aleatório ideal) ganha a mais rápida. A escolha fica em "ht->hashChoice" e os itens já inseridos são
+ * redistribuídos com a nova função.
+ * NOTA: só em tabelas com função de hash completa e sem semente (ver htSetHashSeed)
+ *
+ * @param ht
+ * @param keys amostra de chaves
+ * @param lengths comprimento de cada chave
+ * @param n dimensão da amostra
+ * @param all devolve a avaliação de cada função, pela ordem de "hashKnownAlgorithms" (pode ser NULL)
+ * @return int posição em "hashKnownAlgorithms" da função escolhida, -1 se a amostra tiver menos de 2 chaves
+ */
+int htSelectHashKey(HashTableCFG *ht, const void **keys, const unsigned int *lengths, size_t n, HashTableHashReport *all)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(!ht->hashSeed); // com semente o hash não depende de "hashKey"
+    ht->autoHashSample = 0;
+    if (n < 2)
+        return -1;
+    size_t m = htTableSize(ht, ht->loadFactorMax > 0 ? (size_t)((double)n / ht->loadFactorMax) : n);
+    size_t *counts = (size_t *)malloc(m * sizeof(size_t));
+    HashTableHashReport *r = all ? all : (HashTableHashReport *)malloc((size_t)hashKnownAlgorithmsCount * sizeof(HashTableHashReport));
+    assert(counts && r);
+    double minVariance = 0;
+    for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+    {
+        r[f].algorithm = f;
+        r[f].name = hashKnownAlgorithms[f].name;
+        htEvalHashKey(ht, hashKnownAlgorithms[f].func, keys, lengths, n, m, counts, &r[f]);
+        if (f == 0 || r[f].varianceRatio < minVariance)
+            minVariance = r[f].varianceRatio;
+    }
+    // numa amostra pequena até um hash ideal se afasta de 1, por isso a referência nunca desce abaixo disso
+    double limite = (1 + HT_AUTOHASH_SLACK) * (minVariance > 1 ? minVariance : 1);
+    int best = -1;
+    for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+    {
+        if (r[f].varianceRatio <= limite && (best < 0 || r[f].nsPerKey < r[best].nsPerKey))
+            best = f;
+    }
+    ht->hashChoice = r[best];
+    TfuncHashKnownAlgorithm anterior = ht->hashKey;
+    ht->hashKey = hashKnownAlgorithms[best].func;
+    if (ht->hashKey != anterior && ht->totalItems > 0)
+        htRehashKeys(ht);
+    free(counts);
+    if (!all)
+        free(r);
+    return best;
+}
+
+/**
+ * @brief procedimento para a tabela escolher sozinha a função de hash: as primeiras "sampleSize" chaves
+ * inseridas são a amostra de htSelectHashKey (até lá é usada a função indicada na criação); htInsertDataParallel
+ * usa como amostra as primeiras chaves da carga. A escolha e as suas medições ficam em "ht->hashChoice".
+ * NOTA: só pode ser ligado antes da primeira inserção e só em tabelas com função de hash completa e sem semente
+ *
+ * @param ht
+ * @param sampleSize chaves da amostra, 0 = HT_AUTOHASH_SAMPLE
+ */
+void htSetAutoHash(HashTableCFG *ht, size_t sampleSize)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(!ht->hashSeed);
+    assert(ht->totalItems == 0);
+    ht->autoHashSample = sampleSize ? sampleSize : HT_AUTOHASH_SAMPLE;
+}
+
+// uso interno, não exportar!!!!!
+// a amostra da escolha automática está completa: as chaves são as da própria tabela
+void htAutoHashNow(HashTableCFG *ht)
+{
+    htRehashAll(ht);
+    const void **keys = (const void **)malloc(ht->totalItems * sizeof(const void *));
+    unsigned int *lengths = (unsigned int *)malloc(ht->totalItems * sizeof(unsigned int));
+    assert(keys && lengths);
+    size_t n = 0;
+    for (size_t i = 0; i < ht->M; i++)
+    {
+        for (NodoHashTable *nodo = ht->hashtable[i]; nodo; nodo = nodo->next)
+        {
+            keys[n] = htNodoKey(ht, nodo);
+            lengths[n++] = nodo->length;
+        }
+    }
+    htSelectHashKey(ht, keys, lengths, n, NULL);
+    free(keys);
+    free(lengths);
+}
+
+// uso interno, não exportar!!!!!
+void htInsertNewNodo(HashTableCFG *ht, void *data, const void *key, unsigned int length, unsigned int h, size_t pos)
+{
+    ht->hashtable[pos] = htHeadInsertNodo(ht, ht->hashtable[pos], data, key, h, length);
+    if (ht->statsTracking)
+        htStatsRowChanged(ht, ht->rowStats + pos, 1, ht->hashtable[pos]);
+    htTreeRowAdded(ht, pos, ht->hashtable[pos]);
+    if (ht->bloom)
+    {
+        // o filtro foi dimensionado para "capacity" chaves, acima disso é refeito com o dobro
+        if (ht->bloom->items >= ht->bloom->capacity)
+            htSetBloomFilter(ht, 2 * ht->totalItems + 2, ht->bloom->fpRate);
+        else
+            bloomAdd(ht->bloom, htBloomHash(key, length));
+    }
+    ht->nextDataID++;
+    ht->totalItems++;
+    if (ht->autoHashSample && ht->totalItems >= ht->autoHashSample)
+        htAutoHashNow(ht);
+    htCheckLoadFactor(ht);
+}
+
+/**
+ * @brief procedimento para ligar (ou refazer) o filtro de Bloom consultado antes de percorrer as listas:
+ * as pesquisas de chaves inexistentes terminam quase sempre no filtro (contador "BloomSaved").
+ * O filtro é mantido por htInsertData e refeito automaticamente com o dobro da capacidade quando fica cheio;
+ * as remoções não limpam o filtro (apenas aumentam os falsos positivos até ser refeito).
+ *
+ * @param ht
+ * @param expectedItems número de chaves previsto (nunca menos do que as já existentes)
+ * @param fpRate taxa de falsos positivos pretendida, 0 desliga o filtro
+ */
+void htSetBloomFilter(HashTableCFG *ht, size_t expectedItems, double fpRate)
+{
+    assert(ht);
+    if (ht->bloom)
+        ht->bloom = destroyBloomFilter(ht->bloom);
+    if (fpRate <= 0)
+        return;
+    ht->bloom = newBloomFilter(expectedItems > ht->totalItems ? expectedItems : ht->totalItems, fpRate);
+    for (int t = 0; t < 2; t++)
+    {
+        NodoHashTable **rows = t == 0 ? ht->hashtable : ht->oldHashtable;
+        size_t m = t == 0 ? ht->M : ht->oldM;
+        for (size_t i = 0; rows && i < m; i++)
+        {
+            for (NodoHashTable *nodo = rows[i]; nodo; nodo = nodo->next)
+            {
+                unsigned int length;
+                const void *key = htDataKey(ht, nodo->data, &length);
+                bloomAdd(ht->bloom, htBloomHash(key, length));
+            }
+        }
+    }
+}
+
+// uso interno, não exportar!!!!!
+// incrementa o contador do nodo encontrado pela última pesquisa (htFindKeyHashed)
+void htRepeatNodo(HashTableCFG *ht, NodoHashTable *nodo)
+{
+    nodo->count++;
+    if (!ht->statsTracking)
+        return;
+    // só muda a soma dos contadores da linha do nodo (na tabela nova ou, durante um rehash, na antiga)
+    ht->lastFoundRow->count++;
+    htStatsColisions(ht, ht->lastFoundRow->count - 1, ht->lastFoundRow->count);
+}
+
+// uso interno, não exportar!!!!!
+bool htExistKeyColision(HashTableCFG *ht, const void *key, unsigned int length, bool registar)
+{
+    unsigned int h;
+    size_t pos;
+    NodoHashTable *nodo = htFindKey(ht, key, length, &h, &pos);
+    ht->lastFound = nodo;
+    if (nodo && registar)
+        htRepeatNodo(ht, nodo);
+    return nodo ? true : false;
+}
+
+/**
+ * @brief função para inserir dados na hashtable
+ *
+ * @param ht
+ * @param data
+ * @return true
+ * @return false
+ */
+bool htInsertData(HashTableCFG *ht, void *data)
+{
+    assert(ht);
+    assert(ht->hash || ht->hashKey);
+    unsigned int length, h;
+    size_t pos;
+    // o hash e o comprimento são calculados uma única vez e ficam guardados no nodo
+    const void *key = htDataKey(ht, data, &length);
+    NodoHashTable *nodo = htFindKey(ht, key, length, &h, &pos);
+    ht->lastFound = nodo;
+    if (nodo)
+    {
+        htRepeatNodo(ht, nodo);
+        return false;
+    }
+    htInsertNewNodo(ht, data, key, length, h, pos);
+    return true;
+}
+
+/**
+ * @brief função para contar mais uma ocorrência de uma chave binária sem ter ainda os dados: se a chave existe
+ * só é incrementado o contador "count" (a chave não é copiada), senão os dados são criados com "nd" (por exemplo
+ * uma cópia da chave, quando "key" aponta para memória que não vai durar) e inseridos como em htInsertData
+ * NOTA: só em tabelas com função de hash completa (a chave não precisa de terminar em '\0')
+ *
+ * @param ht
+ * @param key
+ * @param length
+ * @param nd função que cria os dados de uma chave nova, "getString"/"getKey" dos dados devolvem a mesma chave
+ * @return true se a chave foi inserida
+ * @return false se a chave já existia
+ */
+bool htCountKey(HashTableCFG *ht, const void *key, unsigned int length, TfuncHashTableNewData nd)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(nd);
+    unsigned int h;
+    size_t pos;
+    NodoHashTable *nodo = htFindKey(ht, key, length, &h, &pos);
+    ht->lastFound = nodo;
+    if (nodo)
+    {
+        htRepeatNodo(ht, nodo);
+        return false;
+    }
+    htInsertNewNodo(ht, nd(key, length), key, length, h, pos);
+    return true;
+}
+
+/**
+ * @brief função para verificar se existe uma string na hashtable
+ *
+ * @param ht
+ * @param v
+ * @return true
+ * @return false
+ */
+bool htExistString(HashTableCFG *ht, char *v)
+{
+    assert(ht);
+    assert(ht->hash || ht->hashKey);
+    return htExistKeyColision(ht, v, (unsigned int)strlen(v), false);
+}
+
+/**
+ * @brief função para verificar se existe uma chave binária com "length" bytes na hashtable
+ *
+ * @param ht
+ * @param key
+ * @param length
+ * @return true
+ * @return false
+ */
+bool htExistKey(HashTableCFG *ht, const void *key, unsigned int length)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    return htExistKeyColision(ht, key, length, false);
+}
+
+/**
+ * @brief função para verificar se existe uma chave inteira na hashtable
+ * NOTA: "getKey" deve devolver o apontador para um "unsigned long long" com 8 bytes
+ *
+ * @param ht
+ * @param key
+ * @return true
+ * @return false
+ */
+bool htExistKeyInt(HashTableCFG *ht, unsigned long long key)
+{
+    return htExistKey(ht, &key, (unsigned int)sizeof(key));
+}
+
+// uso interno, não exportar!!!!!
+// primeira fase de um lote: calcular hash/posição de cada chave e pedir ao processador as linhas e os primeiros nodos
+void htBatchPrefetch(HashTableCFG *ht, const void **keys, const unsigned int *lengths, size_t n, unsigned int *h, size_t *pos)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        h[i] = htHashKey(ht, keys[i], lengths[i], &pos[i]);
+        __builtin_prefetch(&ht->hashtable[pos[i]]);
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        // __builtin_prefetch(NULL) é permitido e não tem efeito
+        __builtin_prefetch(ht->hashtable[pos[i]]);
+    }
+}
+
+/**
+ * @brief função para pesquisar "n" chaves binárias de uma só vez: as chaves são todas calculadas primeiro
+ * e as linhas/nodos são pedidos antecipadamente ao processador (prefetch), assim as faltas de cache
+ * de chaves diferentes sobrepõem-se em vez de acontecerem uma a uma
+ *
+ * @param ht
+ * @param keys
+ * @param lengths
+ * @param n
+ * @param results devolve para cada chave os dados encontrados ou NULL (pode ser NULL)
+ * @return size_t número de chaves encontradas
+ */
+size_t htExistKeyBatch(HashTableCFG *ht, const void **keys, const unsigned int *lengths, size_t n, void **results)
+{
+    assert(ht);
+    assert(ht->hash || ht->hashKey);
+    unsigned int h[HT_BATCH];
+    size_t pos[HT_BATCH];
+    size_t encontrados = 0;
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t lote = n - base < HT_BATCH ? n - base : HT_BATCH;
+        // o mesmo ritmo de migração de "lote" operações individuais
+        if (ht->oldHashtable)
+            htRehashStep(ht, HT_REHASH_STEP * lote);
+        htBatchPrefetch(ht, keys + base, lengths + base, lote, h, pos);
+        for (size_t i = 0; i < lote; i++)
+        {
+            NodoHashTable *nodo = htFindKeyHashed(ht, keys[base + i], lengths[base + i], h[i], pos[i]);
+            if (nodo)
+                encontrados++;
+            if (results)
+                results[base + i] = nodo ? nodo->data : NULL;
+        }
+    }
+    ht->lastFound = NULL;
+    return encontrados;
+}
+
+/**
+ * @brief função para pesquisar "n" strings de uma só vez (ver htExistKeyBatch)
+ *
+ * @param ht
+ * @param v
+ * @param n
+ * @param results devolve para cada string os dados encontrados ou NULL (pode ser NULL)
+ * @return size_t número de strings encontradas
+ */
+size_t htExistStringBatch(HashTableCFG *ht, char **v, size_t n, void **results)
+{
+    assert(ht);
+    unsigned int lengths[HT_BATCH];
+    size_t encontrados = 0;
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t lote = n - base < HT_BATCH ? n - base : HT_BATCH;
+        for (size_t i = 0; i < lote; i++)
+        {
+            lengths[i] = (unsigned int)strlen(v[base + i]);
+        }
+        encontrados += htExistKeyBatch(ht, (const void **)(v + base), lengths, lote, results ? results + base : NULL);
+    }
+    return encontrados;
+}
+
+/**
+ * @brief função para inserir "n" dados de uma só vez, com as mesmas regras de htInsertData
+ * (as chaves repetidas, mesmo dentro do lote, incrementam o contador do nodo)
+ *
+ * @param ht
+ * @param data
+ * @param n
+ * @param inserted devolve para cada item se foi inserido (pode ser NULL)
+ * @return size_t número de itens inseridos
+ */
+size_t htInsertDataBatch(HashTableCFG *ht, void **data, size_t n, bool *inserted)
+{
+    assert(ht);
+    assert(ht->hash || ht->hashKey);
+    const void *keys[HT_BATCH];
+    unsigned int lengths[HT_BATCH], h[HT_BATCH];
+    size_t pos[HT_BATCH];
+    size_t novos = 0;
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t lote = n - base < HT_BATCH ? n - base : HT_BATCH;
+        // o mesmo ritmo de migração de "lote" operações individuais
+        if (ht->oldHashtable)
+            htRehashStep(ht, HT_REHASH_STEP * lote);
+        for (size_t i = 0; i < lote; i++)
+        {
+            keys[i] = htDataKey(ht, data[base + i], &lengths[i]);
+        }
+        htBatchPrefetch(ht, keys, lengths, lote, h, pos);
+        size_t m = ht->M;
+        TfuncHashKnownAlgorithm fh = ht->hashKey;
+        for (size_t i = 0; i < lote; i++)
+        {
+            // uma inserção pode ter iniciado um rehash ou escolhido outra função de hash (htSetAutoHash),
+            // nesse caso os hashes e as posições já calculados deixam de servir
+            if (ht->M != m || ht->hashKey != fh)
+                h[i] = htHashKey(ht, keys[i], lengths[i], &pos[i]);
+            NodoHashTable *nodo = htFindKeyHashed(ht, keys[i], lengths[i], h[i], pos[i]);
+            if (nodo)
+                htRepeatNodo(ht, nodo);
+            else
+                htInsertNewNodo(ht, data[base + i], keys[i], lengths[i], h[i], pos[i]);
+            if (inserted)
+                inserted[base + i] = nodo ? false : true;
+            novos += nodo ? 0 : 1;
+        }
+    }
+    ht->lastFound = NULL;
+    return novos;
+}
+
+/**
+ * @brief estado partilhado pelas threads de htInsertDataParallel
+ */
+typedef struct htbulkctx HtBulkCtx;
+struct htbulkctx {
+    HashTableCFG *ht;
+    void **data;
+    size_t n;
+    int threads;                /**< número de threads, de fatias de itens e de blocos de linhas. */
+    const void **keys;          /**< chave de cada item. */
+    unsigned int *lengths, *h;  /**< comprimento e hash completo de cada item. */
+    size_t *pos;                /**< linha de cada item. */
+    size_t *counts;             /**< counts[t * threads + s] = itens da fatia "t" que caem no bloco de linhas "s". */
+    size_t *order;              /**< índices dos itens agrupados por bloco de linhas (pela ordem original dentro de cada bloco). */
+    bool *inserted;             /**< resultado de cada item. */
+};
+
+/**
+ * @brief trabalho de cada thread de htInsertDataParallel: a fatia de itens [n*id/threads, n*(id+1)/threads)
+ * e o bloco de linhas [M*id/threads, M*(id+1)/threads)
+ */
+typedef struct htbulkworker HtBulkWorker;
+struct htbulkworker {
+    HtBulkCtx *ctx;
+    int id;
+    int fase;                   /**< 0 = hash das chaves, 1 = distribuição pelos blocos, 2 = inserção. */
+    NodoHashTableSlab *slabs;   /**< blocos do alocador "slab" reservados por esta thread. */
+    size_t slabBlocks;
+    size_t novos;               /**< itens inseridos pela thread. */
+};
+
+// uso interno, não exportar!!!!!
+// bloco de linhas da linha "pos": blocos contíguos, cada um é percorrido por uma única thread
+size_t htBulkShard(HtBulkCtx *ctx, size_t pos)
+{
+    return pos * (size_t)ctx->threads / ctx->ht->M;
+}
+
+// uso interno, não exportar!!!!!
+// reserva um nodo sem tocar no estado partilhado da tabela (a lista de nodos livres fica para as inserções normais)
+NodoHashTable *htBulkNewNodo(HtBulkWorker *w, const void *key, unsigned int length)
+{
+    HashTableCFG *ht = w->ctx->ht;
+    if (ht->inlineKeys)
+        return htNewNodoInline(key, length);
+    if (ht->slabBlockNodes > 0)
+    {
+        if (!w->slabs || w->slabs->used == ht->slabBlockNodes)
+        {
+            w->slabs = htNewSlabBlock(ht->slabBlockNodes, w->slabs);
+            w->slabBlocks++;
+        }
+        return &w->slabs->nodos[w->slabs->used++];
+    }
+    NodoHashTable *cell = (NodoHashTable *)malloc(sizeof(NodoHashTable));
+    assert(cell);
+    return cell;
+}
+
+// uso interno, não exportar!!!!!
+void *htBulkWorker(void *arg)
+{
+    HtBulkWorker *w = (HtBulkWorker *)arg;
+    HtBulkCtx *ctx = w->ctx;
+    HashTableCFG *ht = ctx->ht;
+    size_t t = (size_t)ctx->threads, id = (size_t)w->id;
+    size_t i0 = ctx->n * id / t, i1 = ctx->n * (id + 1) / t;
+    if (w->fase == 0)
+    {
+        size_t *counts = &ctx->counts[id * t];
+        for (size_t i = i0; i < i1; i++)
+        {
+            ctx->keys[i] = htDataKey(ht, ctx->data[i], &ctx->lengths[i]);
+            ctx->h[i] = htHashKey(ht, ctx->keys[i], ctx->lengths[i], &ctx->pos[i]);
+            counts[htBulkShard(ctx, ctx->pos[i])]++;
+        }
+    }
+    else if (w->fase == 1)
+    {
+        // cada bloco começa depois de todos os blocos anteriores e, dentro do bloco, depois das fatias anteriores
+        size_t *next = (size_t *)calloc(t, sizeof(size_t));
+        assert(next);
+        for (size_t s = 0, base = 0; s < t; s++)
+        {
+            next[s] = base;
+            for (size_t f = 0; f < t; f++)
+            {
+                if (f < id)
+                    next[s] += ctx->counts[f * t + s];
+                base += ctx->counts[f * t + s];
+            }
+        }
+        for (size_t i = i0; i < i1; i++)
+        {
+            ctx->order[next[htBulkShard(ctx, ctx->pos[i])]++] = i;
+        }
+        free(next);
+    }
+    else
+    {
+        // o bloco "id" ocupa em "order" as posições [k0, k1)
+        size_t k0 = 0, k1 = 0;
+        for (size_t f = 0; f < t; f++)
+        {
+            for (size_t s = 0; s < id; s++)
+            {
+                k0 += ctx->counts[f * t + s];
+            }
+            k1 += ctx->counts[f * t + id];
+        }
+        k1 += k0;
+        // itens pela ordem original: a primeira ocorrência de cada chave fica na tabela, as seguintes só contam
+        for (size_t k = k0; k < k1; k++)
+        {
+            size_t i = ctx->order[k], pos = ctx->pos[i], probes = 0;
+            const void *key = ctx->keys[i];
+            unsigned int length = ctx->lengths[i], h = ctx->h[i];
+            NodoHashTable *nodo = ht->trees && ht->trees[pos] ? htTreeFind(ht, ht->trees[pos], key, length, h, &probes)
+                                                              : htFindKeyRow(ht, ht->hashtable[pos], key, length, h, &probes);
+            ctx->inserted[i] = nodo ? false : true;
+            if (nodo)
+            {
+                nodo->count++;
+                continue;
+            }
+            nodo = htBulkNewNodo(w, key, length);
+            nodo->next = ht->hashtable[pos];
+            nodo->data = ctx->data[i];
+            nodo->count = 0;
+            nodo->hash = h;
+            nodo->length = length;
+            ht->hashtable[pos] = nodo;
+            if (ht->trees && ht->trees[pos])
+                ht->trees[pos] = htTreeInsert(ht, ht->trees[pos], nodo, key);
+            else if (ht->trees && htRowLongerThan(nodo, HT_TREEIFY_THRESHOLD))
+                ht->trees[pos] = htTreeBuildRow(ht, nodo);
+            w->novos++;
+        }
+    }
+    return NULL;
+}
+
+// uso interno, não exportar!!!!!
+// executa uma fase em todas as threads; a thread que chama faz a parte 0 e, se não for possível criar
+// uma thread, a sua parte é feita aqui mesmo (as partes de uma fase são independentes)
+void htBulkRun(HtBulkWorker *w, pthread_t *th, bool *criada, int threads, int fase)
+{
+    for (int i = 0; i < threads; i++)
+    {
+        w[i].fase = fase;
+    }
+    for (int i = 1; i < threads; i++)
+    {
+        criada[i] = pthread_create(&th[i], NULL, htBulkWorker, &w[i]) == 0;
+    }
+    htBulkWorker(&w[0]);
+    for (int i = 1; i < threads; i++)
+    {
+        if (criada[i])
+            pthread_join(th[i], NULL);
+        else
+            htBulkWorker(&w[i]);
+    }
+}
+
+/**
+ * @brief função para carregar muitos itens de uma só vez em várias threads (por exemplo um dicionário):
+ * a tabela é dimensionada uma única vez para o fator de carga alvo, as chaves são calculadas em paralelo,
+ * os itens são distribuídos por blocos contíguos de linhas (um por thread) e cada thread insere o seu bloco
+ * sem trincos; no fim os blocos já fazem parte da mesma tabela, só falta acertar os totais, o filtro de Bloom
+ * e as estatísticas. O resultado é o mesmo de htInsertData item a item: a primeira ocorrência de cada chave
+ * é inserida e as seguintes incrementam o contador "count" (os dados repetidos continuam a ser do chamador).
+ * NOTA: só em tabelas com função de hash completa; "getString"/"getKey"/"keyEquals" são chamadas em paralelo
+ * e a tabela não pode ser usada por outras threads durante a carga
+ *
+ * @param ht
+ * @param data
+ * @param n
+ * @param threads número de threads, 0 = número de processadores
+ * @param inserted devolve para cada item se foi inserido (pode ser NULL)
+ * @return size_t número de itens inseridos
+ */
+size_t htInsertDataParallel(HashTableCFG *ht, void **data, size_t n, int threads, bool *inserted)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    if (threads <= 0)
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    // com poucos itens por thread não compensa criar as threads
+    if (threads <= 1 || n < (size_t)threads * HT_PARALLEL_MIN_ITEMS)
+        return htInsertDataBatch(ht, data, n, inserted);
+
+    if (ht->autoHashSample)
+    {
+        // a amostra da escolha automática são as primeiras chaves da carga
+        size_t k = n < ht->autoHashSample ? n : ht->autoHashSample;
+        const void **keys = (const void **)malloc(k * sizeof(const void *));
+        unsigned int *lengths = (unsigned int *)malloc(k * sizeof(unsigned int));
+        assert(keys && lengths);
+        for (size_t i = 0; i < k; i++)
+        {
+            keys[i] = htDataKey(ht, data[i], &lengths[i]);
+        }
+        htSelectHashKey(ht, keys, lengths, k, NULL);
+        free(keys);
+        free(lengths);
+    }
+    htRehashAll(ht);
+    if (ht->loadFactorMax > 0)
+    {
+        // no pior caso todos os itens são novos
+        size_t m = (size_t)((double)(ht->totalItems + n) / ht->loadFactorMax) + 1;
+        m = htTableSize(ht, m);
+        if (m > ht->M)
+        {
+            htStartRehash(ht, m);
+            htRehashAll(ht);
+        }
+    }
+    // as árvores das linhas longas são criadas pelas próprias threads, o array tem de existir antes
+    if (ht->treeify && !ht->keyEquals && !ht->trees)
+    {
+        ht->trees = (NodoHashTableTree **)calloc(ht->M, sizeof(NodoHashTableTree *));
+        assert(ht->trees);
+    }
+
+    HtBulkCtx ctx;
+    ctx.ht = ht;
+    ctx.data = data;
+    ctx.n = n;
+    ctx.threads = threads;
+    ctx.keys = (const void **)malloc(n * sizeof(const void *));
+    ctx.lengths = (unsigned int *)malloc(n * sizeof(unsigned int));
+    ctx.h = (unsigned int *)malloc(n * sizeof(unsigned int));
+    ctx.pos = (size_t *)malloc(n * sizeof(size_t));
+    ctx.order = (size_t *)malloc(n * sizeof(size_t));
+    ctx.counts = (size_t *)calloc((size_t)threads * (size_t)threads, sizeof(size_t));
+    ctx.inserted = inserted ? inserted : (bool *)malloc(n * sizeof(bool));
+    HtBulkWorker *w = (HtBulkWorker *)calloc((size_t)threads, sizeof(HtBulkWorker));
+    pthread_t *th = (pthread_t *)malloc((size_t)threads * sizeof(pthread_t));
+    bool *criada = (bool *)malloc((size_t)threads * sizeof(bool));
+    assert(ctx.keys && ctx.lengths && ctx.h && ctx.pos && ctx.order && ctx.counts && ctx.inserted && w && th && criada);
+    for (int i = 0; i < threads; i++)
+    {
+        w[i].ctx = &ctx;
+        w[i].id = i;
+    }
+    for (int fase = 0; fase < 3; fase++)
+    {
+        htBulkRun(w, th, criada, threads, fase);
+    }
+
+    size_t novos = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        novos += w[i].novos;
+        if (w[i].slabs)
+        {
+            // os blocos da thread passam para a lista da tabela (o mais recente, ainda com nodos livres, fica à cabeça)
+            NodoHashTableSlab *last = w[i].slabs;
+            while (last->next)
+                last = last->next;
+            last->next = ht->slabs;
+            ht->slabs = w[i].slabs;
+            ht->slabBlocks += w[i].slabBlocks;
+        }
+    }
+    ht->totalItems += novos;
+    ht->nextDataID += novos;
+    ht->lastFound = NULL;
+    if (ht->trees)
+    {
+        ht->TreeifiedRows = 0;
+        for (size_t i = 0; i < ht->M; i++)
+        {
+            if (ht->trees[i])
+                ht->TreeifiedRows++;
+        }
+        if (ht->TreeifiedRows == 0)
+            htTreeFreeAll(ht);
+    }
+    if (ht->bloom)
+    {
+        if (ht->totalItems > ht->bloom->capacity)
+            htSetBloomFilter(ht, 2 * ht->totalItems + 2, ht->bloom->fpRate);
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                if (ctx.inserted[i])
+                    bloomAdd(ht->bloom, htBloomHash(ctx.keys[i], ctx.lengths[i]));
+            }
+        }
+    }
+    if (ht->statsTracking)
+        htStatsCalc(ht);
+    htCheckLoadFactor(ht);
+
+    free(ctx.keys);
+    free(ctx.lengths);
+    free(ctx.h);
+    free(ctx.pos);
+    free(ctx.order);
+    free(ctx.counts);
+    if (!inserted)
+        free(ctx.inserted);
+    free(w);
+    free(th);
+    free(criada);
+    return novos;
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTable **htFindKeyLinkRow(HashTableCFG *ht, NodoHashTable **link, const void *key, unsigned int length, unsigned int h)
+{
+    while (*link && ((*link)->hash != h || (*link)->length != length || !htNodoKeyEquals(ht, *link, key, length)))
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+// uso interno, não exportar!!!!!
+// pesquisa na linha "row" com a árvore "tree" (pode ser NULL)
+NodoHashTable **htFindKeyLinkTree(HashTableCFG *ht, NodoHashTable **row, NodoHashTableTree *tree, const void *key, unsigned int length, unsigned int h)
+{
+    if (!tree)
+        return htFindKeyLinkRow(ht, row, key, length, h);
+    // a árvore encontra o nodo, a lista só é percorrida para chegar ao apontador que lhe dá acesso
+    size_t probes = 0;
+    NodoHashTable *nodo = htTreeFind(ht, tree, key, length, h, &probes);
+    NodoHashTable **link;
+    for (link = row; *link && *link != nodo; link = &(*link)->next)
+        ;
+    return link;
+}
+
+// uso interno, não exportar!!!!!
+// devolve também em "row" o início da linha onde o nodo está e em "pos" a linha da chave na tabela atual
+NodoHashTable **htFindKeyLink(HashTableCFG *ht, const void *key, unsigned int length, NodoHashTable ***row, size_t *pos)
+{
+    unsigned int h = htHashKey(ht, key, length, pos);
+    (*row) = &ht->hashtable[*pos];
+    NodoHashTable **link = htFindKeyLinkTree(ht, *row, ht->trees ? ht->trees[*pos] : NULL, key, length, h);
+    if (!(*link) && ht->oldHashtable)
+    {
+        size_t oldPos = ht->hashKey ? htBucket(ht, h, ht->oldM) : htPosicao(ht, (char *)key, ht->oldM);
+        (*row) = &ht->oldHashtable[oldPos];
+        link = htFindKeyLinkTree(ht, *row, ht->oldTrees ? ht->oldTrees[oldPos] : NULL, key, length, h);
+    }
+    return *link ? link : NULL;
+}
+
+// uso interno, não exportar!!!!!
+void htUnlinkNodo(HashTableCFG *ht, NodoHashTable **link, NodoHashTable **row, size_t pos)
+{
+    NodoHashTable *nodo = *link;
+    if (row == &ht->hashtable[pos])
+        htTreeRowRemoving(ht, ht->trees, ht->hashtable, pos, nodo);
+    else
+        htTreeRowRemoving(ht, ht->oldTrees, ht->oldHashtable, (size_t)(row - ht->oldHashtable), nodo);
+    (*link) = nodo->next;
+    if (ht->statsTracking)
+        htStatsRowChanged(ht, row == &ht->hashtable[pos] ? ht->rowStats + pos : ht->oldRowStats + (row - ht->oldHashtable), -1, nodo);
+    ht->destroy(nodo->data);
+    htRecycleNodo(ht, nodo);
+    ht->totalItems--;
+    ht->lastFound = NULL;
+    htCheckLoadFactor(ht);
+}
+
+/**
+ * @brief função para remover da hashtable a chave binária com "length" bytes, os dados são libertados com "destroy"
+ *
+ * @param ht
+ * @param key
+ * @param length
+ * @return true
+ * @return false se a chave não existir
+ */
+bool htRemoveKey(HashTableCFG *ht, const void *key, unsigned int length)
+{
+    assert(ht);
+    assert(ht->destroy);
+    if (ht->oldHashtable)
+        htRehashStep(ht, HT_REHASH_STEP);
+    NodoHashTable **row;
+    size_t pos;
+    NodoHashTable **link = htFindKeyLink(ht, key, length, &row, &pos);
+    if (!link)
+        return false;
+    htUnlinkNodo(ht, link, row, pos);
+    return true;
+}
+
+/**
+ * @brief função para remover uma string da hashtable, os dados são libertados com "destroy"
+ *
+ * @param ht
+ * @param v
+ * @return true
+ * @return false se a string não existir
+ */
+bool htRemoveString(HashTableCFG *ht, char *v)
+{
+    return htRemoveKey(ht, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief função para remover o nodo encontrado na última pesquisa ("lastFound")
+ *
+ * @param ht
+ * @return true
+ * @return false se a última pesquisa não encontrou nada
+ */
+bool htRemoveLastFound(HashTableCFG *ht)
+{
+    assert(ht);
+    assert(ht->destroy);
+    if (!ht->lastFound)
+        return false;
+    // localizar a linha a partir da chave do próprio nodo para obter o apontador que lhe dá acesso
+    unsigned int length;
+    const void *key = htDataKey(ht, ht->lastFound->data, &length);
+    NodoHashTable **row;
+    size_t pos;
+    NodoHashTable **link = htFindKeyLink(ht, key, length, &row, &pos);
+    assert(link && *link == ht->lastFound);
+    htUnlinkNodo(ht, link, row, pos);
+    return true;
+}
+
+// uso interno, não exportar!!!!!
+// desce o nodo da posição "i" no min-heap (ordenado por "count") com "n" elementos
+void htTopKSiftDown(NodoHashTable **heap, size_t n, size_t i)
+{
+    NodoHashTable *x = heap[i];
+    for (size_t c = 2 * i + 1; c < n; c = 2 * i + 1)
+    {
+        if (c + 1 < n && heap[c + 1]->count < heap[c]->count)
+            c++;
+        if (heap[c]->count >= x->count)
+            break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = x;
+}
+
+/**
+ * @brief função para obter os "k" nodos com maior contador ("count", as repetições de cada chave) numa só passagem
+ * pela tabela, com um min-heap limitado a "k" elementos: O(n log k) e sem copiar a tabela
+ *
+ * @param ht
+ * @param k
+ * @param out array com espaço para "k" nodos, devolvido por ordem decrescente de "count"
+ * @return size_t número de nodos devolvidos (menor do que "k" se a tabela tiver menos itens)
+ */
+size_t htTopK(HashTableCFG *ht, size_t k, NodoHashTable **out)
+{
+    assert(ht);
+    assert(out);
+    size_t n = 0;
+    if (k == 0)
+        return 0;
+    for (int t = 0; t < 2; t++)
+    {
+        NodoHashTable **rows = t == 0 ? ht->hashtable : ht->oldHashtable;
+        size_t m = t == 0 ? ht->M : ht->oldM;
+        for (size_t i = 0; rows && i < m; i++)
+        {
+            for (NodoHashTable *nodo = rows[i]; nodo; nodo = nodo->next)
+            {
+                if (n < k)
+                {
+                    // encher o heap, subindo o novo nodo
+                    size_t j = n++;
+                    while (j > 0 && out[(j - 1) / 2]->count > nodo->count)
+                    {
+                        out[j] = out[(j - 1) / 2];
+                        j = (j - 1) / 2;
+                    }
+                    out[j] = nodo;
+                }
+                else if (nodo->count > out[0]->count)
+                {
+                    // substituir o menor dos "k" maiores
+                    out[0] = nodo;
+                    htTopKSiftDown(out, n, 0);
+                }
+            }
+        }
+    }
+    // ordenar: retirar sucessivamente o menor para o fim do array
+    for (size_t j = n; j > 1; j--)
+    {
+        NodoHashTable *menor = out[0];
+        out[0] = out[j - 1];
+        out[j - 1] = menor;
+        htTopKSiftDown(out, j - 1, 0);
+    }
+    return n;
+}
+
+/**
+ * @brief função para inicializar uma hashtable
+ *
+ * @param m número de linhas pedido, a tabela fica com o primo mais próximo (>= m)
+ * @param fh
+ * @param dd
+ * @param gs
+ * @return HashTableCFG*
+ */
+HashTableCFG *newHashTable(size_t m, TfuncHashTableHashFunc fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+{
+    HashTableCFG *novo = (HashTableCFG *)malloc(sizeof(HashTableCFG));
+    assert(novo);
+    novo->sizing = HT_SIZING_PRIME;
+    novo->M = htTableSizeInitial(novo, m); // procura o número primo mais próximo para reduzir o número de colisões na HT
+    novo->StatsMax = novo->StatsMin = novo->ColisionsMax = novo->ColisionsMin = novo->EmptyRow = 0;
     novo->nextDataID = 1;
     novo->hash = fh;
     novo->getString = gs;
     novo->destroy = dd;
+    novo->hashKey = NULL;
+    novo->getKey = NULL;
+    novo->keyEquals = NULL;
     novo->lastFound = NULL;
-    novo->hashtable = calloc(m, sizeof(NodoHashTable));
-    assert(novo->hashtable);
+    novo->hashtable = htNewRows(novo->M);
+    novo->totalItems = 0;
+    novo->initialM = novo->M;
+    // a função de hash antiga devolve a posição, pode não usar "M": só cresce se for pedido (htSetLoadFactor)
+    novo->loadFactorMax = 0;
+    novo->loadFactorMin = HT_LOAD_FACTOR_MIN;
+    novo->loadFactor = 0;
+    novo->oldM = 0;
+    novo->rehashPos = 0;
+    novo->oldHashtable = NULL;
+    novo->freeNodes = NULL;
+    novo->freeNodesCount = 0;
+    novo->slabs = NULL;
+    novo->slabBlockNodes = 0;
+    novo->slabBlocks = 0;
+    novo->bloom = NULL;
+    novo->BloomSaved = novo->BloomFalsePositives = 0;
+    novo->statsTracking = false;
+    novo->colisionsDirty = false;
+    novo->chainHistogram = NULL;
+    novo->chainHistogramSize = 0;
+    novo->rowStats = novo->oldRowStats = novo->lastFoundRow = NULL;
+    novo->lookupsHit = novo->probesHit = novo->lookupsMiss = novo->probesMiss = 0;
+    novo->inlineKeys = false;
+    novo->trees = NULL;
+    novo->oldTrees = NULL;
+    novo->TreeifiedRows = 0;
+    novo->treeify = true;
+    novo->hashSeed = 0;
+    novo->autoHashSample = 0;
+    memset(&novo->hashChoice, 0, sizeof(HashTableHashReport));
+    novo->hashChoice.algorithm = -1;
+    return novo;
+}
+
+/**
+ * @brief função para inicializar uma hashtable com uma função de hash completa (ex: "DJBHash")
+ * a posição é calculada pela hashtable e o hash fica guardado em cada nodo, assim as
+ * pesquisas comparam primeiro inteiros e o rehash não volta a chamar "getString"
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gs
+ * @return HashTableCFG*
+ */
+HashTableCFG *newHashTableHashKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+{
+    HashTableCFG *novo = newHashTable(m, NULL, dd, gs);
+    novo->hashKey = fh;
+    // a posição é calculada pela própria tabela, por isso pode crescer por omissão
+    novo->loadFactorMax = HT_LOAD_FACTOR_MAX;
+    return novo;
+}
+
+/**
+ * @brief função para inicializar uma hashtable com chaves binárias (apontador + comprimento)
+ * as chaves não precisam de ser strings terminadas em '\0', ex: inteiros ou chaves compostas
+ *
+ * @param m
+ * @param fh função de hash completa, recebe os bytes da chave e o comprimento
+ * @param dd
+ * @param gk função que devolve a chave e o respetivo comprimento dos dados
+ * @param eq função de igualdade das chaves (NULL = comparar os bytes com "memcmp")
+ * @return HashTableCFG*
+ */
+HashTableCFG *newHashTableKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq)
+{
+    assert(fh);
+    assert(gk);
+    HashTableCFG *novo = newHashTableHashKey(m, fh, dd, NULL);
+    novo->getKey = gk;
+    novo->keyEquals = eq;
     return novo;
 }
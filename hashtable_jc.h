@@ -15,37 +15,255 @@
 #define INC_14AED2HASH_HASH_JC_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hash_known_algorithms.h"
+#include "bloom_jc.h"
+
+/**
+ * @brief fator de carga por omissão a partir do qual a hashtable cresce (itens / M), nas tabelas com função de hash
+ * completa ("newHashTableHashKey"/"newHashTableKey"); as tabelas de "newHashTable" só crescem com htSetLoadFactor
+ */
+#define HT_LOAD_FACTOR_MAX 1.0f
+
+/**
+ * @brief fator de carga por omissão abaixo do qual a hashtable encolhe (0 = nunca encolhe)
+ */
+#define HT_LOAD_FACTOR_MIN 0.0f
+
+/**
+ * @brief número de linhas da tabela antiga migradas em cada operação durante um rehash incremental
+ */
+#define HT_REHASH_STEP 4
+
+/**
+ * @brief número máximo de linhas: o hash das chaves tem 32 bits, por isso não há como distribuir por mais linhas;
+ * acima disto a tabela deixa de crescer e o fator de carga passa o alvo (as linhas longas passam a árvores);
+ * com "size_t" de 32 bits o limite é a maior potência de 2 representável
+ */
+#if SIZE_MAX > 0xFFFFFFFFU
+#define HT_MAX_M ((size_t)1 << 32)
+#else
+#define HT_MAX_M ((size_t)1 << 31)
+#endif
+
+/**
+ * @brief forma de dimensionar a tabela e de calcular a linha de cada hash (só com função de hash completa, ver htSetSizing)
+ */
+typedef enum tipoDimensaoHashTable
+{
+    HT_SIZING_PRIME,            /**< M primo, linha = hash % M (por omissão). */
+    HT_SIZING_POW2_MASK,        /**< M potência de 2, linha = mix(hash) & (M - 1). */
+    HT_SIZING_POW2_FASTRANGE    /**< M potência de 2, linha = (mix(hash) * M) >> 32 (redução de Lemire). */
+} HashTableSizing;
 
 typedef struct nodohashtable NodoHashTable;
 struct nodohashtable {
     void *data;
-    int count;
+    unsigned long long count;   /**< número de vezes que os dados foram inseridos novamente. */
+    unsigned int hash;      /**< hash completo da chave (0 se a tabela usa a função de hash antiga). */
+    unsigned int length;    /**< comprimento da chave, calculado uma única vez na inserção. */
     NodoHashTable *next;
 };
 
+/**
+ * @brief nodo com a cópia da chave guardada logo a seguir (ver htSetInlineKeys): comparar uma chave
+ * da lista lê apenas o próprio nodo, sem passar por "data" e "getString"/"getKey"
+ */
+typedef struct nodohashtableinline NodoHashTableInline;
+struct nodohashtableinline {
+    NodoHashTable nodo;     /**< nodo normal (tem de ser o primeiro campo). */
+    char key[];             /**< bytes da chave ("nodo.length") seguidos de '\0'. */
+};
+
+/**
+ * @brief linhas com mais de HT_TREEIFY_THRESHOLD nodos ganham uma árvore AVL ordenada por (hash, comprimento, bytes da chave),
+ * que é desfeita quando a linha desce para HT_UNTREEIFY_THRESHOLD nodos
+ */
+#define HT_TREEIFY_THRESHOLD 8
+#define HT_UNTREEIFY_THRESHOLD 6
+
+/**
+ * @brief nodo da árvore de uma linha longa: indexa um nodo da lista, que continua a ser a lista da linha
+ */
+typedef struct nodohashtabletree NodoHashTableTree;
+struct nodohashtabletree {
+    NodoHashTable *nodo;                    /**< nodo da lista indexado. */
+    NodoHashTableTree *left, *right;
+    int altura;                             /**< altura da subárvore (AVL). */
+};
+
+/**
+ * @brief número de chaves tratadas em conjunto pelas funções de lote (htExistKeyBatch, htInsertDataBatch)
+ */
+#define HT_BATCH 32
+
+/**
+ * @brief htInsertDataParallel só usa threads com pelo menos este número de itens por thread
+ */
+#define HT_PARALLEL_MIN_ITEMS 4096
+
+/**
+ * @brief bloco contíguo de nodos do alocador "slab" da hashtable
+ */
+typedef struct nodohashtableslab NodoHashTableSlab;
+struct nodohashtableslab {
+    NodoHashTableSlab *next;    /**< bloco reservado anteriormente. */
+    size_t used;                /**< nodos já entregues deste bloco. */
+    NodoHashTable nodos[];      /**< nodos do bloco. */
+};
+
+/**
+ * @brief dimensão por omissão da amostra da escolha automática da função de hash (ver htSetAutoHash)
+ */
+#define HT_AUTOHASH_SAMPLE 1024
+
+/**
+ * @brief folga da escolha automática: as funções com variância dos comprimentos das linhas até (1 + folga) vezes
+ * a melhor (e a de um hash aleatório ideal) contam como bem distribuídas, entre elas ganha a mais rápida
+ */
+#define HT_AUTOHASH_SLACK 0.25
+
+/**
+ * @brief avaliação de uma função de hash sobre uma amostra de chaves (ver htSelectHashKey)
+ */
+typedef struct hashtablehashreport HashTableHashReport;
+struct hashtablehashreport {
+    int algorithm;          /**< posição em "hashKnownAlgorithms" (-1 = ainda não houve escolha). */
+    const char *name;       /**< nome da função. */
+    size_t sampleSize;      /**< chaves da amostra. */
+    size_t M;               /**< linhas usadas na avaliação (as da tabela para a amostra com o fator de carga alvo). */
+    double nsPerKey;        /**< tempo médio de hash por chave, em nanossegundos. */
+    double varianceRatio;   /**< variância dos comprimentos das linhas / comprimento médio (1 = hash aleatório ideal). */
+    double avgProbes;       /**< média de nodos visitados numa pesquisa com sucesso. */
+    size_t maxChain;        /**< maior linha. */
+};
+
 typedef int (*TfuncHashTableHashFunc)(void*, void*);
 typedef void (*TfuncHashTableDestroyData)(void*);
 typedef char *(*TfuncHashTableGetString)(void*);
+typedef const void *(*TfuncHashTableGetKey)(void *data, unsigned int *length);
+typedef bool (*TfuncHashTableKeyEquals)(const void *a, unsigned int la, const void *b, unsigned int lb);
+typedef void *(*TfuncHashTableNewData)(const void *key, unsigned int length);
+
+/**
+ * @brief comprimento e soma dos contadores de uma linha, mantidos em cada operação com "statsTracking"
+ */
+typedef struct hashtablerowstats HashTableRowStats;
+struct hashtablerowstats {
+    size_t length;              /**< nodos da linha. */
+    unsigned long long count;   /**< soma dos contadores dos nodos da linha. */
+};
 
 typedef struct hashtablecfg HashTableCFG;
 struct hashtablecfg {
-    int M, StatsMax, StatsMin, ColisionsMax, ColisionsMin, EmptyRow;
-    int nextDataID;
+    size_t M, StatsMax, StatsMin, EmptyRow;
+    unsigned long long ColisionsMax, ColisionsMin;
+    unsigned long long nextDataID;
     NodoHashTable **hashtable;
     NodoHashTable *lastFound;
     TfuncHashTableHashFunc hash;
     TfuncHashTableGetString getString;
     TfuncHashTableDestroyData destroy;
+    TfuncHashKnownAlgorithm hashKey;    /**< função de hash completa (alternativa a "hash", ver newHashTableHashKey). */
+    TfuncHashTableGetKey getKey;        /**< função que devolve a chave binária dos dados (alternativa a "getString"). */
+    TfuncHashTableKeyEquals keyEquals;  /**< função de igualdade das chaves binárias (NULL = memcmp). */
+    size_t totalItems;              /**< total de itens guardados na hashtable. */
+    size_t initialM;                 /**< dimensão inicial, a hashtable nunca encolhe abaixo deste valor. */
+    float loadFactorMax;            /**< fator de carga alvo: cresce quando é ultrapassado (0 = desligado). */
+    float loadFactorMin;            /**< fator de carga mínimo: encolhe quando fica abaixo (0 = desligado). */
+    float loadFactor;               /**< fator de carga atual (totalItems / M). */
+    size_t oldM;                    /**< dimensão da tabela antiga durante um rehash. */
+    size_t rehashPos;               /**< próxima linha da tabela antiga a migrar (só com "oldHashtable"). */
+    NodoHashTable **oldHashtable;   /**< tabela antiga durante um rehash incremental. */
+    NodoHashTable *freeNodes;       /**< nodos libertados por remoções, reaproveitados nas inserções seguintes. */
+    size_t freeNodesCount;          /**< total de nodos na lista "freeNodes". */
+    NodoHashTableSlab *slabs;       /**< blocos de nodos do alocador "slab" (o mais recente primeiro). */
+    size_t slabBlockNodes;          /**< nodos por bloco (0 = cada nodo é reservado com malloc). */
+    size_t slabBlocks;              /**< total de blocos reservados. */
+    BloomFilter *bloom;             /**< filtro de Bloom consultado antes das listas (NULL = desligado). */
+    unsigned long long BloomSaved;          /**< pesquisas resolvidas pelo filtro sem percorrer a lista. */
+    unsigned long long BloomFalsePositives; /**< pesquisas em que o filtro respondeu "talvez" e a chave não existia. */
+    bool statsTracking;             /**< estatísticas mantidas em cada inserção/remoção (ver htSetStatsTracking). */
+    size_t *chainHistogram;         /**< chainHistogram[l] = número de linhas com "l" nodos (só com "statsTracking"). */
+    size_t chainHistogramSize;      /**< dimensão reservada do array "chainHistogram". */
+    HashTableRowStats *rowStats;    /**< estatísticas de cada linha da tabela atual (só com "statsTracking"). */
+    HashTableRowStats *oldRowStats; /**< estatísticas de cada linha da tabela antiga durante um rehash. */
+    HashTableRowStats *lastFoundRow;/**< estatísticas da linha do último nodo encontrado (só com "statsTracking"). */
+    bool colisionsDirty;            /**< "ColisionsMax"/"ColisionsMin" a recalcular no próximo htStatsRead (ver htStatsColisions). */
+    unsigned long long lookupsHit, probesHit;   /**< pesquisas com sucesso e total de nodos visitados por elas. */
+    unsigned long long lookupsMiss, probesMiss; /**< pesquisas sem sucesso e total de nodos visitados por elas. */
+    bool inlineKeys;                /**< os nodos guardam uma cópia da chave (NodoHashTableInline, ver htSetInlineKeys). */
+    HashTableSizing sizing;         /**< dimensionamento da tabela e cálculo da linha (ver htSetSizing). */
+    NodoHashTableTree **trees;      /**< árvore de cada linha longa da tabela atual (NULL = nenhuma linha com árvore). */
+    NodoHashTableTree **oldTrees;   /**< árvore de cada linha longa da tabela antiga ainda por migrar durante um rehash. */
+    size_t TreeifiedRows;           /**< linhas com árvore (também recalculado por htStatsCalc). */
+    bool treeify;                   /**< converter as linhas longas em árvores (ligado por omissão, ver htSetTreeify). */
+    unsigned long long hashSeed;    /**< semente do hash das chaves (0 = usa "hashKey", ver htSetHashSeed). */
+    size_t autoHashSample;          /**< chaves a inserir até à escolha automática da função de hash (0 = desligada, ver htSetAutoHash). */
+    HashTableHashReport hashChoice; /**< última escolha da função de hash e as suas medições (ver htSelectHashKey). */
 };
 
+/**
+ * @brief cópia das estatísticas da hashtable, preenchida em O(1) por htStatsRead
+ */
+typedef struct hashtablestats HashTableStats;
+struct hashtablestats {
+    size_t M, totalItems;                   /**< número de linhas e de itens. */
+    size_t StatsMax, StatsMin, EmptyRow;    /**< maior/menor lista e linhas vazias. */
+    unsigned long long ColisionsMax, ColisionsMin; /**< maior/menor soma dos contadores de uma linha. */
+    float loadFactor;                       /**< itens / M. */
+    double avgProbeHit, avgProbeMiss;       /**< média de nodos visitados nas pesquisas com/sem sucesso. */
+    const size_t *chainHistogram;           /**< histograma dos comprimentos (NULL sem "statsTracking"), válido até à próxima alteração. */
+    size_t chainHistogramSize;              /**< entradas do histograma (StatsMax + 1). */
+    size_t treeifiedRows;                   /**< linhas com árvore (ver htSetTreeify). */
+};
+
+/*
+ * funções internas partilhadas pelos módulos das tabelas (hashtable_mt_jc, robinhood_jc, mphf_jc, ...),
+ * para que cada detalhe tenha uma única implementação
+ */
+const void *htKeyOf(TfuncHashTableGetKey gk, TfuncHashTableGetString gs, void *data, unsigned int *length);
+const void *htDataKey(HashTableCFG *ht, void *data, unsigned int *length);
+const void *htNodoKey(HashTableCFG *ht, NodoHashTable *nodo);
+unsigned int htMix(unsigned int h);
+
 int fakeHashFunc(void *d, void *ctx);
 void fakeHashDestroy(void *d);
 
-HashTableCFG *newHashTable(int m, TfuncHashTableHashFunc fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+HashTableCFG *newHashTable(size_t m, TfuncHashTableHashFunc fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+HashTableCFG *newHashTableHashKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+HashTableCFG *newHashTableKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq);
 HashTableCFG *destroyHashTable(HashTableCFG *ht);
 
+void htSetSlabAllocator(HashTableCFG *ht, size_t nodesPerBlock);
+void htSetInlineKeys(HashTableCFG *ht);
+void htSetSizing(HashTableCFG *ht, HashTableSizing sizing);
+void htSetTreeify(HashTableCFG *ht, bool on);
+void htSetHashSeed(HashTableCFG *ht, unsigned long long seed);
+void htSetAutoHash(HashTableCFG *ht, size_t sampleSize);
+int htSelectHashKey(HashTableCFG *ht, const void **keys, const unsigned int *lengths, size_t n, HashTableHashReport *all);
+size_t htSizingBucket(HashTableSizing sizing, unsigned int h, size_t m);
+void htSetBloomFilter(HashTableCFG *ht, size_t expectedItems, double fpRate);
+void htSetLoadFactor(HashTableCFG *ht, float max, float min);
+void htSetStatsTracking(HashTableCFG *ht, bool on);
+bool htIsRehashing(HashTableCFG *ht);
+void htRehashAll(HashTableCFG *ht);
+
 bool htInsertData(HashTableCFG *ht, void *data);
+bool htCountKey(HashTableCFG *ht, const void *key, unsigned int length, TfuncHashTableNewData nd);
 bool htExistString(HashTableCFG *ht, char *v);
+bool htExistKey(HashTableCFG *ht, const void *key, unsigned int length);
+bool htExistKeyInt(HashTableCFG *ht, unsigned long long key);
+size_t htExistStringBatch(HashTableCFG *ht, char **v, size_t n, void **results);
+size_t htExistKeyBatch(HashTableCFG *ht, const void **keys, const unsigned int *lengths, size_t n, void **results);
+size_t htInsertDataBatch(HashTableCFG *ht, void **data, size_t n, bool *inserted);
+size_t htInsertDataParallel(HashTableCFG *ht, void **data, size_t n, int threads, bool *inserted);
+bool htRemoveString(HashTableCFG *ht, char *v);
+bool htRemoveKey(HashTableCFG *ht, const void *key, unsigned int length);
+bool htRemoveLastFound(HashTableCFG *ht);
 void htStatsCalc(HashTableCFG *ht);
+void htStatsRead(HashTableCFG *ht, HashTableStats *stats);
+size_t htTopK(HashTableCFG *ht, size_t k, NodoHashTable **out);
 
 #endif //INC_14AED2HASH_HASH_JC_H
@@ -0,0 +1,396 @@
+/**
+ * @file hashtable_mt_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação de uma hashtable com listas partilhável entre threads.
+ * As pesquisas percorrem as listas sem trincos, as inserções/remoções bloqueiam só a faixa de linhas da chave.
+ * Os nodos removidos só são libertados quando nenhuma thread leitora os pode estar a ler
+ * (reclamação por épocas: cada leitora anuncia a época global quando entra na tabela).
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include "hashtable_mt_jc.h"
+#include "lib_jc.h"
+
+/**
+ * @brief número de nodos removidos acumulados antes de tentar avançar a época e libertá-los
+ */
+#define HTMT_RETIRE_BATCH 64
+
+// identificadores das threads (um bit por identificador ocupado), partilhados por todas as tabelas
+static atomic_ulong htmtThreadIds[HTMT_MAX_THREADS / 64];
+static _Thread_local int htmtThreadId = -1;
+static pthread_key_t htmtThreadKey;
+static pthread_once_t htmtThreadOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief procedimento chamado quando uma thread termina, liberta o identificador (NOTA: é um procedimento interno)
+ *
+ * @param v identificador + 1
+ */
+void htmtReleaseThreadId(void *v)
+{
+    int id = (int)((intptr_t)v - 1);
+    atomic_fetch_and(&htmtThreadIds[id / 64], ~(1UL << (id % 64)));
+}
+
+// uso interno, não exportar!!!!!
+void htmtInitThreadKey(void)
+{
+    pthread_key_create(&htmtThreadKey, htmtReleaseThreadId);
+}
+
+/**
+ * @brief função que devolve o identificador (0..HTMT_MAX_THREADS-1) da thread atual (NOTA: é uma função interna)
+ *
+ * @return int
+ */
+int htmtGetThreadId(void)
+{
+    if (htmtThreadId >= 0)
+        return htmtThreadId;
+    pthread_once(&htmtThreadOnce, htmtInitThreadKey);
+    for (int w = 0; w < HTMT_MAX_THREADS / 64; w++)
+    {
+        unsigned long bits = atomic_load(&htmtThreadIds[w]);
+        while (~bits)
+        {
+            int b = __builtin_ctzl(~bits);
+            if (atomic_compare_exchange_weak(&htmtThreadIds[w], &bits, bits | (1UL << b)))
+            {
+                htmtThreadId = w * 64 + b;
+                pthread_setspecific(htmtThreadKey, (void *)(intptr_t)(htmtThreadId + 1));
+                return htmtThreadId;
+            }
+        }
+    }
+    assert(!"demasiadas threads em simultâneo (HTMT_MAX_THREADS)");
+    return -1;
+}
+
+/**
+ * @brief função para anunciar a entrada da thread na tabela com a época global atual (NOTA: é uma função interna)
+ *
+ * @param ht
+ * @return int identificador da thread
+ */
+int htmtEnter(HashTableMTCFG *ht)
+{
+    int id = htmtGetThreadId();
+    atomic_store(&ht->readers[id].epoch, atomic_load(&ht->epoch));
+    return id;
+}
+
+// uso interno, não exportar!!!!!
+void htmtLeave(HashTableMTCFG *ht, int id)
+{
+    atomic_store_explicit(&ht->readers[id].epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief procedimento para avançar a época (se todas as leitoras já a viram) e libertar os nodos removidos
+ * há pelo menos duas épocas (NOTA: é um procedimento interno, chamado com "retiredLock")
+ *
+ * @param ht
+ */
+void htmtCollect(HashTableMTCFG *ht)
+{
+    unsigned long e = atomic_load(&ht->epoch);
+    bool avancar = true;
+    for (int i = 0; i < HTMT_MAX_THREADS && avancar; i++)
+    {
+        unsigned long r = atomic_load(&ht->readers[i].epoch);
+        if (r && r != e)
+            avancar = false;
+    }
+    if (avancar)
+        atomic_compare_exchange_strong(&ht->epoch, &e, e + 1);
+    e = atomic_load(&ht->epoch);
+    NodoHashTableMT **link = &ht->retired;
+    while (*link)
+    {
+        NodoHashTableMT *nodo = *link;
+        if (nodo->retiredEpoch + 2 <= e)
+        {
+            (*link) = nodo->retiredNext;
+            ht->destroy(nodo->data);
+            free(nodo);
+            ht->retiredCount--;
+        }
+        else
+        {
+            link = &nodo->retiredNext;
+        }
+    }
+}
+
+/**
+ * @brief procedimento para guardar um nodo já desligado da lista até poder ser libertado (NOTA: é um procedimento interno)
+ *
+ * @param ht
+ * @param nodo
+ */
+void htmtRetire(HashTableMTCFG *ht, NodoHashTableMT *nodo)
+{
+    pthread_mutex_lock(&ht->retiredLock);
+    nodo->retiredEpoch = atomic_load(&ht->epoch);
+    nodo->retiredNext = ht->retired;
+    ht->retired = nodo;
+    ht->retiredCount++;
+    if (ht->retiredCount >= HTMT_RETIRE_BATCH)
+        htmtCollect(ht);
+    pthread_mutex_unlock(&ht->retiredLock);
+}
+
+// uso interno, não exportar!!!!!
+NodoHashTableMT *htmtFindKeyRow(HashTableMTCFG *ht, NodoHashTableMT *nodo, const void *key, unsigned int length, unsigned int h)
+{
+    while (nodo)
+    {
+        if (nodo->hash == h && nodo->length == length)
+        {
+            unsigned int l = length;
+            const void *k = htKeyOf(ht->getKey, ht->getString, nodo->data, &l);
+            if (ht->keyEquals ? ht->keyEquals(k, l, key, length) : memcmp(k, key, length) == 0)
+                return nodo;
+        }
+        nodo = atomic_load_explicit(&nodo->next, memory_order_acquire);
+    }
+    return NULL;
+}
+
+// uso interno, não exportar!!!!!
+bool htmtExistKeyHash(HashTableMTCFG *ht, const void *key, unsigned int length, unsigned int h, bool registar)
+{
+    int id = htmtEnter(ht);
+    NodoHashTableMT *nodo = htmtFindKeyRow(ht, atomic_load_explicit(&ht->hashtable[h % ht->M], memory_order_acquire), key, length, h);
+    if (nodo && registar)
+        atomic_fetch_add_explicit(&nodo->count, 1, memory_order_relaxed);
+    htmtLeave(ht, id);
+    return nodo ? true : false;
+}
+
+/**
+ * @brief função para inserir dados na tabela, se a chave já existir incrementa o contador do nodo
+ *
+ * @param ht
+ * @param data
+ * @return true
+ * @return false se a chave já existia
+ */
+bool htmtInsertData(HashTableMTCFG *ht, void *data)
+{
+    assert(ht);
+    unsigned int length;
+    const void *key = htKeyOf(ht->getKey, ht->getString, data, &length);
+    unsigned int h = ht->hash((const char *)key, length);
+    // caso mais comum nos dados repetidos: resolvido sem trincos
+    if (htmtExistKeyHash(ht, key, length, h, true))
+        return false;
+    size_t pos = h % ht->M;
+    pthread_mutex_t *lock = &ht->stripes[pos % HTMT_STRIPES].lock;
+    pthread_mutex_lock(lock);
+    // voltar a procurar, outra thread pode ter inserido a mesma chave entretanto
+    NodoHashTableMT *head = atomic_load_explicit(&ht->hashtable[pos], memory_order_acquire);
+    NodoHashTableMT *nodo = htmtFindKeyRow(ht, head, key, length, h);
+    if (nodo)
+    {
+        atomic_fetch_add_explicit(&nodo->count, 1, memory_order_relaxed);
+        pthread_mutex_unlock(lock);
+        return false;
+    }
+    NodoHashTableMT *novo = (NodoHashTableMT *)malloc(sizeof(NodoHashTableMT));
+    assert(novo);
+    novo->data = data;
+    novo->hash = h;
+    novo->length = length;
+    atomic_init(&novo->count, 0);
+    atomic_init(&novo->next, head);
+    novo->retiredNext = NULL;
+    novo->retiredEpoch = 0;
+    // publicar o nodo já preenchido para as leitoras
+    atomic_store_explicit(&ht->hashtable[pos], novo, memory_order_release);
+    pthread_mutex_unlock(lock);
+    atomic_fetch_add(&ht->totalItems, 1);
+    return true;
+}
+
+/**
+ * @brief função para verificar se existe uma chave binária com "length" bytes na tabela (sem trincos)
+ *
+ * @param ht
+ * @param key
+ * @param length
+ * @return true
+ * @return false
+ */
+bool htmtExistKey(HashTableMTCFG *ht, const void *key, unsigned int length)
+{
+    assert(ht);
+    return htmtExistKeyHash(ht, key, length, ht->hash((const char *)key, length), false);
+}
+
+/**
+ * @brief função para verificar se existe uma string na tabela (sem trincos)
+ *
+ * @param ht
+ * @param v
+ * @return true
+ * @return false
+ */
+bool htmtExistString(HashTableMTCFG *ht, char *v)
+{
+    return htmtExistKey(ht, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief função para remover uma chave binária da tabela, os dados são libertados com "destroy"
+ * quando nenhuma thread os puder estar a ler
+ *
+ * @param ht
+ * @param key
+ * @param length
+ * @return true
+ * @return false se a chave não existir
+ */
+bool htmtRemoveKey(HashTableMTCFG *ht, const void *key, unsigned int length)
+{
+    assert(ht);
+    unsigned int h = ht->hash((const char *)key, length);
+    size_t pos = h % ht->M;
+    pthread_mutex_t *lock = &ht->stripes[pos % HTMT_STRIPES].lock;
+    pthread_mutex_lock(lock);
+    _Atomic(NodoHashTableMT *) *link = &ht->hashtable[pos];
+    NodoHashTableMT *nodo = atomic_load_explicit(link, memory_order_relaxed);
+    NodoHashTableMT *alvo = htmtFindKeyRow(ht, nodo, key, length, h);
+    if (!alvo)
+    {
+        pthread_mutex_unlock(lock);
+        return false;
+    }
+    while (nodo != alvo)
+    {
+        link = &nodo->next;
+        nodo = atomic_load_explicit(link, memory_order_relaxed);
+    }
+    // as leitoras que já estão no nodo continuam a conseguir avançar pelo "next" dele
+    atomic_store_explicit(link, atomic_load_explicit(&alvo->next, memory_order_relaxed), memory_order_release);
+    pthread_mutex_unlock(lock);
+    atomic_fetch_sub(&ht->totalItems, 1);
+    htmtRetire(ht, alvo);
+    return true;
+}
+
+/**
+ * @brief função para remover uma string da tabela
+ *
+ * @param ht
+ * @param v
+ * @return true
+ * @return false se a string não existir
+ */
+bool htmtRemoveString(HashTableMTCFG *ht, char *v)
+{
+    return htmtRemoveKey(ht, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief função para destruir a tabela (NOTA: nenhuma outra thread pode estar a usar a tabela)
+ *
+ * @param ht
+ * @return HashTableMTCFG*
+ */
+HashTableMTCFG *destroyHashTableMT(HashTableMTCFG *ht)
+{
+    assert(ht);
+    for (size_t i = 0; i < ht->M; i++)
+    {
+        NodoHashTableMT *nodo = atomic_load(&ht->hashtable[i]);
+        while (nodo)
+        {
+            NodoHashTableMT *ptr = atomic_load(&nodo->next);
+            ht->destroy(nodo->data);
+            free(nodo);
+            nodo = ptr;
+        }
+    }
+    while (ht->retired)
+    {
+        NodoHashTableMT *ptr = ht->retired->retiredNext;
+        ht->destroy(ht->retired->data);
+        free(ht->retired);
+        ht->retired = ptr;
+    }
+    for (int i = 0; i < HTMT_STRIPES; i++)
+    {
+        pthread_mutex_destroy(&ht->stripes[i].lock);
+    }
+    pthread_mutex_destroy(&ht->retiredLock);
+    free(ht->hashtable);
+    free(ht);
+    return NULL;
+}
+
+/**
+ * @brief função para inicializar uma tabela partilhável com chaves binárias
+ * NOTA: o número de linhas é fixo, deve ser dimensionado para o número de itens esperado
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gk
+ * @param eq função de igualdade das chaves (NULL = memcmp)
+ * @return HashTableMTCFG*
+ */
+HashTableMTCFG *newHashTableMTKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq)
+{
+    assert(fh);
+    HashTableMTCFG *novo = (HashTableMTCFG *)memalign(64, sizeof(HashTableMTCFG));
+    assert(novo);
+    novo->M = getNearestPrimeNumber(m);
+    atomic_init(&novo->totalItems, 0);
+    novo->hashtable = (_Atomic(NodoHashTableMT *) *)calloc(novo->M, sizeof(_Atomic(NodoHashTableMT *)));
+    assert(novo->hashtable);
+    for (int i = 0; i < HTMT_STRIPES; i++)
+    {
+        pthread_mutex_init(&novo->stripes[i].lock, NULL);
+    }
+    atomic_init(&novo->epoch, 1);
+    for (int i = 0; i < HTMT_MAX_THREADS; i++)
+    {
+        atomic_init(&novo->readers[i].epoch, 0);
+    }
+    pthread_mutex_init(&novo->retiredLock, NULL);
+    novo->retired = NULL;
+    novo->retiredCount = 0;
+    novo->hash = fh;
+    novo->getString = NULL;
+    novo->getKey = gk;
+    novo->keyEquals = eq;
+    novo->destroy = dd;
+    return novo;
+}
+
+/**
+ * @brief função para inicializar uma tabela partilhável com chaves do tipo string
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gs
+ * @return HashTableMTCFG*
+ */
+HashTableMTCFG *newHashTableMT(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+{
+    HashTableMTCFG *novo = newHashTableMTKey(m, fh, dd, NULL, NULL);
+    novo->getString = gs;
+    return novo;
+}
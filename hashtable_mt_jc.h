@@ -0,0 +1,87 @@
+/**
+ * @file hashtable_mt_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface de uma hashtable com listas partilhável entre threads.
+ * As pesquisas não usam trincos (cabeças das listas atómicas e libertação de memória por épocas),
+ * as inserções/remoções só bloqueiam a faixa ("stripe") de linhas onde a chave cai.
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_HASHTABLE_MT_JC_H
+#define INC_14AED2HASH_HASHTABLE_MT_JC_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "hashtable_jc.h"
+
+/**
+ * @brief número de trincos, cada um protege as linhas "pos % HTMT_STRIPES"
+ */
+#define HTMT_STRIPES 64
+
+/**
+ * @brief número máximo de threads a usar a tabela em simultâneo (identificadores reaproveitados quando a thread termina)
+ */
+#define HTMT_MAX_THREADS 128
+
+typedef struct nodohashtablemt NodoHashTableMT;
+struct nodohashtablemt {
+    void *data;
+    unsigned int hash;                      /**< hash completo da chave. */
+    unsigned int length;                    /**< comprimento da chave. */
+    atomic_ullong count;                    /**< número de vezes que a chave foi inserida novamente. */
+    _Atomic(NodoHashTableMT *) next;        /**< próximo nodo, lido sem trincos pelas pesquisas. */
+    NodoHashTableMT *retiredNext;           /**< lista de nodos removidos à espera de serem libertados. */
+    unsigned long retiredEpoch;             /**< época em que o nodo foi removido. */
+};
+
+/**
+ * @brief trinco de uma faixa, alinhado para que duas faixas não partilhem a mesma linha de cache
+ */
+typedef struct hashtablemtstripe HashTableMTStripe;
+struct hashtablemtstripe {
+    _Alignas(64) pthread_mutex_t lock;
+};
+
+/**
+ * @brief época anunciada por cada thread leitora (0 = fora da tabela), alinhada por linha de cache
+ */
+typedef struct hashtablemtreader HashTableMTReader;
+struct hashtablemtreader {
+    _Alignas(64) atomic_ulong epoch;
+};
+
+typedef struct hashtablemtcfg HashTableMTCFG;
+struct hashtablemtcfg {
+    size_t M;                                       /**< número de linhas (fixo). */
+    atomic_size_t totalItems;                       /**< total de itens guardados. */
+    _Atomic(NodoHashTableMT *) *hashtable;          /**< cabeças das listas. */
+    HashTableMTStripe stripes[HTMT_STRIPES];        /**< trincos das faixas de linhas. */
+    atomic_ulong epoch;                             /**< época global. */
+    HashTableMTReader readers[HTMT_MAX_THREADS];    /**< época anunciada por cada thread. */
+    pthread_mutex_t retiredLock;                    /**< protege a lista de nodos removidos. */
+    NodoHashTableMT *retired;                       /**< nodos removidos ainda não libertados. */
+    int retiredCount;                               /**< total de nodos na lista "retired". */
+    TfuncHashKnownAlgorithm hash;                   /**< função de hash completa. */
+    TfuncHashTableGetString getString;              /**< função que devolve a string dos dados (ou NULL). */
+    TfuncHashTableGetKey getKey;                    /**< função que devolve a chave binária dos dados (ou NULL). */
+    TfuncHashTableKeyEquals keyEquals;              /**< igualdade das chaves binárias (NULL = memcmp). */
+    TfuncHashTableDestroyData destroy;              /**< procedimento para libertar os dados. */
+};
+
+HashTableMTCFG *newHashTableMT(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+HashTableMTCFG *newHashTableMTKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq);
+HashTableMTCFG *destroyHashTableMT(HashTableMTCFG *ht);
+
+bool htmtInsertData(HashTableMTCFG *ht, void *data);
+bool htmtExistString(HashTableMTCFG *ht, char *v);
+bool htmtExistKey(HashTableMTCFG *ht, const void *key, unsigned int length);
+bool htmtRemoveString(HashTableMTCFG *ht, char *v);
+bool htmtRemoveKey(HashTableMTCFG *ht, const void *key, unsigned int length);
+
+#endif //INC_14AED2HASH_HASHTABLE_MT_JC_H
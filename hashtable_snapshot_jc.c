@@ -0,0 +1,245 @@
+/**
+ * @file hashtable_snapshot_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação do "snapshot" de uma hashtable: escrita sequencial do ficheiro e pesquisa sobre o ficheiro
+ * mapeado com "mmap" (só leitura). As chaves de cada linha ficam seguidas no ficheiro, por isso percorrer uma lista
+ * normalmente só toca numa ou duas páginas.
+ * @version 0.1
+ * @date 2021-06-01
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hashtable_snapshot_jc.h"
+
+/**
+ * @brief função que devolve o número de bytes ocupados no ficheiro por uma chave de comprimento "length",
+ * incluindo o '\0' final e o alinhamento a 8 bytes (NOTA: é uma função interna)
+ *
+ * @param length
+ * @return unsigned long long
+ */
+unsigned long long htSnapEntrySize(unsigned int length)
+{
+    return (sizeof(HashTableSnapshotEntry) + length + 1 + 7) & ~7ULL;
+}
+
+/**
+ * @brief função que devolve a chave do ficheiro no deslocamento "offset" se estiver inteira dentro do mapeamento
+ * (NOTA: é uma função interna) um ficheiro corrompido ou truncado não leva a pesquisa para fora do mapeamento
+ *
+ * @param snap
+ * @param offset
+ * @return const HashTableSnapshotEntry* ou NULL se o deslocamento ou o comprimento forem inválidos
+ */
+const HashTableSnapshotEntry *htSnapEntryAt(HashTableSnapshot *snap, unsigned long long offset)
+{
+    // as chaves estão alinhadas a 8 bytes e começam depois do array de linhas
+    if (offset % 8 != 0 || offset < snap->header->buckets + snap->header->M * sizeof(unsigned long long)
+        || offset > snap->size - sizeof(HashTableSnapshotEntry))
+        return NULL;
+    const HashTableSnapshotEntry *entry = (const HashTableSnapshotEntry *)(snap->base + offset);
+    if (entry->length >= snap->size - offset - sizeof(HashTableSnapshotEntry))
+        return NULL;
+    return entry;
+}
+
+/**
+ * @brief função para gravar a tabela num ficheiro "snapshot" (chaves e contadores, os dados não são guardados)
+ * só é possível com tabelas criadas com uma função de hash completa ("newHashTableHashKey" ou "newHashTableKey"),
+ * a mesma função tem de ser indicada em "htOpenSnapshot"; um rehash em curso é terminado antes de gravar.
+ * As pesquisas no ficheiro comparam os bytes das chaves, por isso as tabelas com "keyEquals" não podem ser gravadas
+ *
+ * @param ht
+ * @param path
+ * @return true
+ * @return false se não foi possível escrever o ficheiro
+ */
+bool htSaveSnapshot(HashTableCFG *ht, const char *path)
+{
+    assert(ht);
+    assert(ht->hashKey);
+    assert(!ht->hashSeed); // o ficheiro é pesquisado com "hashKey"
+    assert(!ht->keyEquals); // o ficheiro é pesquisado com "memcmp"
+    htRehashAll(ht);
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return false;
+
+    HashTableSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HTSNAP_MAGIC, sizeof(header.magic));
+    header.version = HTSNAP_VERSION;
+    header.M = (unsigned long long)ht->M;
+    header.totalItems = (unsigned long long)ht->totalItems;
+    header.buckets = sizeof(HashTableSnapshotHeader);
+    header.hashCheck = ht->hashKey(HTSNAP_MAGIC, (unsigned int)strlen(HTSNAP_MAGIC));
+    header.sizing = (unsigned int)ht->sizing;
+
+    unsigned long long *buckets = (unsigned long long *)calloc(ht->M, sizeof(unsigned long long));
+    assert(buckets);
+    bool ok = fseeko(f, (off_t)(header.buckets + ht->M * sizeof(unsigned long long)), SEEK_SET) == 0;
+    unsigned long long offset = header.buckets + ht->M * sizeof(unsigned long long);
+    // reaproveitado para escrever cada chave (cabeçalho + bytes + alinhamento)
+    size_t bufSize = 256;
+    HashTableSnapshotEntry *entry = (HashTableSnapshotEntry *)malloc(bufSize);
+    assert(entry);
+    for (size_t i = 0; ok && i < ht->M; i++)
+    {
+        if (ht->hashtable[i])
+            buckets[i] = offset;
+        for (NodoHashTable *nodo = ht->hashtable[i]; ok && nodo; nodo = nodo->next)
+        {
+            unsigned int length;
+            const void *key = htDataKey(ht, nodo->data, &length);
+            unsigned long long size = htSnapEntrySize(length);
+            if (size > bufSize)
+            {
+                bufSize = (size_t)size;
+                entry = (HashTableSnapshotEntry *)realloc(entry, bufSize);
+                assert(entry);
+            }
+            memset(entry, 0, (size_t)size);
+            entry->next = nodo->next ? offset + size : 0;
+            entry->hash = nodo->hash;
+            entry->length = length;
+            entry->count = nodo->count;
+            memcpy(entry->key, key, length);
+            ok = fwrite(entry, (size_t)size, 1, f) == 1;
+            offset += size;
+        }
+    }
+    header.fileSize = offset;
+    if (ok)
+        ok = fseek(f, 0, SEEK_SET) == 0
+             && fwrite(&header, sizeof(header), 1, f) == 1
+             && fwrite(buckets, sizeof(unsigned long long), ht->M, f) == ht->M;
+    free(entry);
+    free(buckets);
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
+}
+
+/**
+ * @brief função para abrir (mapear só de leitura) um ficheiro gravado com "htSaveSnapshot"
+ * não lê as chaves: cada página só é carregada quando uma pesquisa precisa dela
+ *
+ * @param path
+ * @param fh a mesma função de hash usada na tabela que gravou o ficheiro
+ * @return HashTableSnapshot* ou NULL se o ficheiro não existir, for inválido ou a função de hash não coincidir
+ */
+HashTableSnapshot *htOpenSnapshot(const char *path, TfuncHashKnownAlgorithm fh)
+{
+    assert(fh);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(HashTableSnapshotHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // o mapeamento continua válido depois de fechar o descritor
+    close(fd);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const HashTableSnapshotHeader *header = (const HashTableSnapshotHeader *)base;
+    if (memcmp(header->magic, HTSNAP_MAGIC, sizeof(header->magic)) != 0
+        || header->version != HTSNAP_VERSION
+        || header->fileSize != (unsigned long long)st.st_size
+        || header->M == 0 || header->M > HT_MAX_M
+        || header->sizing > HT_SIZING_POW2_FASTRANGE
+        || header->buckets % 8 != 0 || header->buckets < sizeof(HashTableSnapshotHeader)
+        || header->buckets > header->fileSize
+        || header->M > (header->fileSize - header->buckets) / sizeof(unsigned long long)
+        || header->hashCheck != fh(HTSNAP_MAGIC, (unsigned int)strlen(HTSNAP_MAGIC)))
+    {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    // acessos aleatórios: não vale a pena o kernel ler páginas à frente
+    madvise(base, (size_t)st.st_size, MADV_RANDOM);
+
+    HashTableSnapshot *snap = (HashTableSnapshot *)malloc(sizeof(HashTableSnapshot));
+    assert(snap);
+    snap->base = (const char *)base;
+    snap->size = (size_t)st.st_size;
+    snap->header = header;
+    snap->buckets = (const unsigned long long *)(snap->base + header->buckets);
+    snap->hash = fh;
+    snap->lastFound = NULL;
+    return snap;
+}
+
+/**
+ * @brief função para fechar o snapshot (desfaz o mapeamento)
+ *
+ * @param snap
+ * @return HashTableSnapshot*
+ */
+HashTableSnapshot *htCloseSnapshot(HashTableSnapshot *snap)
+{
+    assert(snap);
+    munmap((void *)snap->base, snap->size);
+    free(snap);
+    return NULL;
+}
+
+/**
+ * @brief função para verificar se existe uma chave binária no snapshot, a chave encontrada (contador incluído)
+ * fica em "snap->lastFound"; cada deslocamento é validado antes de ser seguido (um ficheiro corrompido
+ * pode dar um resultado errado mas não leituras fora do ficheiro)
+ *
+ * @param snap
+ * @param key
+ * @param length
+ * @return true
+ * @return false
+ */
+bool htSnapshotExistKey(HashTableSnapshot *snap, const void *key, unsigned int length)
+{
+    assert(snap);
+    unsigned int h = snap->hash((const char *)key, length);
+    unsigned long long offset = snap->buckets[htSizingBucket((HashTableSizing)snap->header->sizing, h, (size_t)snap->header->M)];
+    const HashTableSnapshotEntry *entry;
+    while (offset && (entry = htSnapEntryAt(snap, offset)) != NULL)
+    {
+        if (entry->hash == h && entry->length == length && memcmp(entry->key, key, length) == 0)
+        {
+            snap->lastFound = entry;
+            return true;
+        }
+        // as chaves de uma linha são escritas por ordem, um deslocamento para trás só pode ser um ciclo
+        if (entry->next <= offset)
+            break;
+        offset = entry->next;
+    }
+    snap->lastFound = NULL;
+    return false;
+}
+
+/**
+ * @brief função para verificar se existe uma string no snapshot
+ *
+ * @param snap
+ * @param v
+ * @return true
+ * @return false
+ */
+bool htSnapshotExistString(HashTableSnapshot *snap, char *v)
+{
+    return htSnapshotExistKey(snap, v, (unsigned int)strlen(v));
+}
@@ -0,0 +1,75 @@
+/**
+ * @file hashtable_snapshot_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface do formato de ficheiro ("snapshot") de uma hashtable: linhas, chaves e contadores num único
+ * ficheiro relocalizável (deslocamentos em vez de apontadores) que é aberto com "mmap" só de leitura.
+ * As pesquisas trabalham diretamente sobre o ficheiro mapeado, sem reservar memória por chave, portanto o arranque
+ * depende das páginas efetivamente lidas e não do número de chaves guardadas.
+ * As chaves são comparadas byte a byte (memcmp), as tabelas com uma igualdade própria ("keyEquals") não podem
+ * ser gravadas. Os deslocamentos lidos do ficheiro são validados antes de serem seguidos.
+ * NOTA: o ficheiro usa a ordem de bytes e os tamanhos da máquina que o escreveu.
+ * @version 0.1
+ * @date 2021-06-01
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_HASHTABLE_SNAPSHOT_JC_H
+#define INC_14AED2HASH_HASHTABLE_SNAPSHOT_JC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hashtable_jc.h"
+
+#define HTSNAP_MAGIC "JCHTSNAP"
+#define HTSNAP_VERSION 2
+
+/**
+ * @brief cabeçalho no início do ficheiro
+ */
+typedef struct hashtablesnapshotheader HashTableSnapshotHeader;
+struct hashtablesnapshotheader {
+    char magic[8];                  /**< HTSNAP_MAGIC. */
+    unsigned int version;           /**< HTSNAP_VERSION. */
+    unsigned int sizing;            /**< HashTableSizing da tabela gravada (define a linha de cada hash). */
+    unsigned long long M;           /**< número de linhas. */
+    unsigned long long totalItems;  /**< total de chaves. */
+    unsigned long long fileSize;    /**< dimensão total do ficheiro. */
+    unsigned long long buckets;     /**< deslocamento do array de linhas (M deslocamentos de 64 bits, 0 = linha vazia). */
+    unsigned int hashCheck;         /**< hash de HTSNAP_MAGIC, para detetar uma função de hash diferente ao abrir. */
+    unsigned int reserved;
+};
+
+/**
+ * @brief cada chave guardada no ficheiro (alinhada a 8 bytes), as chaves de uma linha ficam seguidas
+ */
+typedef struct hashtablesnapshotentry HashTableSnapshotEntry;
+struct hashtablesnapshotentry {
+    unsigned long long next;    /**< deslocamento da próxima chave da linha (0 = fim). */
+    unsigned int hash;          /**< hash completo da chave. */
+    unsigned int length;        /**< comprimento da chave. */
+    unsigned long long count;   /**< contador do nodo original. */
+    char key[];                 /**< bytes da chave seguidos de '\0'. */
+};
+
+/**
+ * @brief snapshot aberto (mapeado em memória)
+ */
+typedef struct hashtablesnapshot HashTableSnapshot;
+struct hashtablesnapshot {
+    const char *base;                           /**< início do mapeamento. */
+    size_t size;                                /**< dimensão do mapeamento. */
+    const HashTableSnapshotHeader *header;      /**< cabeçalho. */
+    const unsigned long long *buckets;          /**< array de linhas. */
+    TfuncHashKnownAlgorithm hash;               /**< função de hash usada para escrever o ficheiro. */
+    const HashTableSnapshotEntry *lastFound;    /**< chave encontrada na última pesquisa. */
+};
+
+bool htSaveSnapshot(HashTableCFG *ht, const char *path);
+HashTableSnapshot *htOpenSnapshot(const char *path, TfuncHashKnownAlgorithm fh);
+HashTableSnapshot *htCloseSnapshot(HashTableSnapshot *snap);
+bool htSnapshotExistKey(HashTableSnapshot *snap, const void *key, unsigned int length);
+bool htSnapshotExistString(HashTableSnapshot *snap, char *v);
+
+#endif //INC_14AED2HASH_HASHTABLE_SNAPSHOT_JC_H
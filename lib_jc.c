@@ -13,6 +13,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
 #include "lib_jc.h"
 
 /**
@@ -21,7 +24,7 @@
  * @param n
  * @return Boolean
  */
-bool isPrimeNumber(int n)
+bool isPrimeNumber(size_t n)
 {
     // testar os casos iniciais
     if (n <= 1)
@@ -31,8 +34,11 @@ bool isPrimeNumber(int n)
     // os numeros multiplos de 2 e 3 também podem ser descartados e depois já só falta testar a partir de 5
     if (n % 2 == 0 || n % 3 == 0)
         return false;
+    // a divisão por tentativa custa O(sqrt(n)), acima de 2^16 o Miller-Rabin é mais rápido
+    if (n >= 65536)
+        return isPrimeNumber64((unsigned long long)n);
     // iniciar o teste a partir de 5 ...
-    for (int i = 5; i * i <= n; i = i + 6)
+    for (size_t i = 5; i * i <= n; i = i + 6)
         if (n % i == 0 || n % (i + 2) == 0)
             return false;
 
@@ -40,23 +46,21 @@ bool isPrimeNumber(int n)
 }
 
 /**
- * @brief procura o próximo número primo depois de "n"
+ * @brief procura o próximo número primo depois de "n" (0 se não existir nenhum primo de 64 bits acima de "n")
  * @param n
  * @return
  */
-int getNextPrimeNumber(int n)
+size_t getNextPrimeNumber(size_t n)
 {
     if (n <= 1)
         return 2;
-    int novo = n;
-    bool found = false;
-    while (!found)
+    // só os ímpares podem ser primos; "novo > n" pára se a soma der a volta
+    for (size_t novo = (n + 1) | 1; novo > n; novo += 2)
     {
-        novo++;
         if (isPrimeNumber(novo))
-            found = true;
+            return novo;
     }
-    return novo;
+    return 0;
 }
 
 /**
@@ -64,9 +68,282 @@ int getNextPrimeNumber(int n)
  * @param n
  * @return
  */
-int getNearestPrimeNumber(int n)
+size_t getNearestPrimeNumber(size_t n)
 {
     if (isPrimeNumber(n))
         return n;
     return getNextPrimeNumber(n);
 }
+
+/**
+ * @brief calcula (a * b) % m sem overflow (NOTA: é uma função interna)
+ *
+ * @param a
+ * @param b
+ * @param m
+ * @return unsigned long long
+ */
+unsigned long long libMulMod(unsigned long long a, unsigned long long b, unsigned long long m)
+{
+#if defined(__SIZEOF_INT128__)
+    return (unsigned long long)((unsigned __int128)a * b % m);
+#else
+    // somas sucessivas de "a" pelos bits de "b", cada soma é feita módulo "m" sem passar os 64 bits
+    unsigned long long r = 0;
+    a %= m;
+    while (b)
+    {
+        if (b & 1)
+            r = r >= m - a ? r - (m - a) : r + a;
+        a = a >= m - a ? a - (m - a) : a + a;
+        b >>= 1;
+    }
+    return r;
+#endif
+}
+
+/**
+ * @brief calcula (b ^ e) % m (NOTA: é uma função interna)
+ *
+ * @param b
+ * @param e
+ * @param m
+ * @return unsigned long long
+ */
+unsigned long long libPowMod(unsigned long long b, unsigned long long e, unsigned long long m)
+{
+    unsigned long long r = 1;
+    b %= m;
+    while (e)
+    {
+        if (e & 1)
+            r = libMulMod(r, b, m);
+        b = libMulMod(b, b, m);
+        e >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief retorna TRUE se "n" for um número primo, para qualquer valor de 64 bits
+ * teste de Miller-Rabin determinístico: as 12 primeiras bases primas chegam para todos os n < 3.3 * 10^24
+ *
+ * @param n
+ * @return Boolean
+ */
+bool isPrimeNumber64(unsigned long long n)
+{
+    static const unsigned long long bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2)
+        return false;
+    for (int i = 0; i < 12; i++)
+    {
+        if (n % bases[i] == 0)
+            return n == bases[i];
+    }
+    // n - 1 = d * 2^r com d ímpar
+    unsigned long long d = n - 1;
+    int r = 0;
+    while ((d & 1) == 0)
+    {
+        d >>= 1;
+        r++;
+    }
+    for (int i = 0; i < 12; i++)
+    {
+        unsigned long long x = libPowMod(bases[i], d, n);
+        if (x == 1 || x == n - 1)
+            continue;
+        bool composto = true;
+        for (int j = 1; j < r && composto; j++)
+        {
+            x = libMulMod(x, x, n);
+            if (x == n - 1)
+                composto = false;
+        }
+        if (composto)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief procura o próximo número primo depois de "n" (0 se não existir nenhum primo de 64 bits acima de "n")
+ * @param n
+ * @return
+ */
+unsigned long long getNextPrimeNumber64(unsigned long long n)
+{
+    if (n < 2)
+        return 2;
+    // só os ímpares podem ser primos
+    for (unsigned long long novo = (n + 1) | 1; novo > n; novo += 2)
+    {
+        if (isPrimeNumber64(novo))
+            return novo;
+    }
+    return 0;
+}
+
+/**
+ * @brief procura o proximo numero primo caso "n" não se um número primo (64 bits)
+ * @param n
+ * @return
+ */
+unsigned long long getNearestPrimeNumber64(unsigned long long n)
+{
+    if (isPrimeNumber64(n))
+        return n;
+    return getNextPrimeNumber64(n);
+}
+
+const unsigned long long hashTablePrimes[] = {
+    29ULL, 53ULL, 97ULL, 193ULL,
+    389ULL, 769ULL, 1543ULL, 3079ULL,
+    6151ULL, 12289ULL, 24593ULL, 49157ULL,
+    98317ULL, 196613ULL, 393241ULL, 786433ULL,
+    1572869ULL, 3145739ULL, 6291469ULL, 12582917ULL,
+    25165843ULL, 50331653ULL, 100663319ULL, 201326611ULL,
+    402653189ULL, 805306457ULL, 1610612741ULL, 3221225473ULL,
+    6442450967ULL, 12884901893ULL, 25769803799ULL, 51539607599ULL,
+    103079215111ULL, 206158430209ULL, 412316860441ULL, 824633720837ULL,
+    1649267441681ULL, 3298534883417ULL, 6597069766657ULL, 13194139533349ULL,
+    26388279066671ULL, 52776558133303ULL, 105553116266509ULL, 211106232533047ULL,
+    422212465066001ULL, 844424930132057ULL, 1688849860263953ULL, 3377699720527897ULL,
+    6755399441055827ULL, 13510798882111519ULL, 27021597764223071ULL, 54043195528445957ULL,
+    108086391056891941ULL, 216172782113783843ULL, 432345564227567621ULL, 864691128455135281ULL,
+    1729382256910270481ULL, 3458764513820540933ULL, 6917529027641081903ULL};
+const int hashTablePrimesCount = (int)(sizeof(hashTablePrimes) / sizeof(hashTablePrimes[0]));
+
+/**
+ * @brief devolve o menor primo da tabela "hashTablePrimes" maior ou igual a "n" (pesquisa binária, sem testar primos)
+ * acima do último valor da tabela devolve getNearestPrimeNumber64(n)
+ *
+ * @param n
+ * @return unsigned long long
+ */
+unsigned long long getHashTablePrime(unsigned long long n)
+{
+    int lo = 0, hi = hashTablePrimesCount;
+    while (lo < hi)
+    {
+        int meio = (lo + hi) / 2;
+        if (hashTablePrimes[meio] < n)
+            lo = meio + 1;
+        else
+            hi = meio;
+    }
+    return lo < hashTablePrimesCount ? hashTablePrimes[lo] : getNearestPrimeNumber64(n);
+}
+
+/**
+ * @brief calcula a raiz quadrada inteira (arredondada para baixo) (NOTA: é uma função interna)
+ *
+ * @param n
+ * @return unsigned long long
+ */
+unsigned long long libSqrt64(unsigned long long n)
+{
+    unsigned long long r = 0;
+    for (int b = 31; b >= 0; b--)
+    {
+        unsigned long long c = r | (1ULL << b);
+        if (c * c <= n)
+            r = c;
+    }
+    return r;
+}
+
+#define LIB_SIEVE_SEGMENT 32768
+
+/**
+ * @brief procura todos os primos no intervalo [lo, hi) com um crivo de Eratóstenes segmentado: os primos até
+ * sqrt(hi) são calculados uma vez e o intervalo é crivado em segmentos de LIB_SIEVE_SEGMENT números
+ * (cabem na cache L1). Quando sqrt(hi) é maior do que o próprio intervalo cada candidato ímpar é testado
+ * com isPrimeNumber64, para que a memória nunca dependa de "hi".
+ *
+ * @param lo
+ * @param hi
+ * @param out array onde são escritos os primos por ordem crescente (pode ser NULL para apenas contar)
+ * @param max número máximo de primos escritos em "out"
+ * @return unsigned long long número de primos no intervalo (pode ser maior do que "max")
+ */
+unsigned long long primeSieveRange(unsigned long long lo, unsigned long long hi, unsigned long long *out, unsigned long long max)
+{
+    unsigned long long total = 0;
+    if (lo < 2)
+        lo = 2;
+    if (hi <= lo)
+        return 0;
+    unsigned long long raiz = libSqrt64(hi - 1);
+    if (raiz > hi - lo)
+    {
+        // intervalo curto com números grandes: crivar até sqrt(hi) custaria mais do que testar cada número
+        for (unsigned long long n = lo; n < hi && n >= lo; n++)
+        {
+            if (isPrimeNumber64(n))
+            {
+                if (out && total < max)
+                    out[total] = n;
+                total++;
+            }
+        }
+        return total;
+    }
+    // primos base até sqrt(hi - 1) com um crivo simples
+    unsigned char *base = (unsigned char *)malloc(raiz + 1);
+    assert(base);
+    memset(base, 1, raiz + 1);
+    unsigned long long nbase = 0;
+    for (unsigned long long i = 2; i <= raiz; i++)
+    {
+        if (!base[i])
+            continue;
+        nbase++;
+        for (unsigned long long j = i * i; j <= raiz; j += i)
+            base[j] = 0;
+    }
+    unsigned long long *primos = (unsigned long long *)malloc((nbase ? nbase : 1) * sizeof(unsigned long long));
+    assert(primos);
+    nbase = 0;
+    for (unsigned long long i = 2; i <= raiz; i++)
+    {
+        if (base[i])
+            primos[nbase++] = i;
+    }
+    free(base);
+
+    unsigned char *segmento = (unsigned char *)malloc(LIB_SIEVE_SEGMENT);
+    assert(segmento);
+    for (unsigned long long inicio = lo; inicio < hi; inicio += LIB_SIEVE_SEGMENT)
+    {
+        unsigned long long fim = hi - inicio < LIB_SIEVE_SEGMENT ? hi : inicio + LIB_SIEVE_SEGMENT;
+        memset(segmento, 1, (size_t)(fim - inicio));
+        for (unsigned long long k = 0; k < nbase; k++)
+        {
+            unsigned long long p = primos[k];
+            if (p * p >= fim)
+                break;
+            // primeiro múltiplo de p no segmento, nunca abaixo de p * p
+            unsigned long long j = (inicio + p - 1) / p * p;
+            if (j < p * p)
+                j = p * p;
+            for (; j < fim; j += p)
+                segmento[j - inicio] = 0;
+        }
+        for (unsigned long long n = inicio; n < fim; n++)
+        {
+            if (segmento[n - inicio])
+            {
+                if (out && total < max)
+                    out[total] = n;
+                total++;
+            }
+        }
+        if (fim == hi)
+            break;
+    }
+    free(segmento);
+    free(primos);
+    return total;
+}
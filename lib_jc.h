@@ -10,12 +10,27 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef interface_lib_jc_h
 #define interface_lib_jc_h
 
-bool isPrimeNumber(int n);
-int getNextPrimeNumber(int n);
-int getNearestPrimeNumber(int n);
+bool isPrimeNumber(size_t n);
+size_t getNextPrimeNumber(size_t n);
+size_t getNearestPrimeNumber(size_t n);
+
+bool isPrimeNumber64(unsigned long long n);
+unsigned long long getNextPrimeNumber64(unsigned long long n);
+unsigned long long getNearestPrimeNumber64(unsigned long long n);
+
+/**
+ * @brief tabela de primos para dimensionar hashtables: cada um fica a meio caminho entre duas potências de 2
+ * (o primeiro primo >= 1.5 * 2^k), por isso cresce aproximadamente para o dobro
+ */
+extern const unsigned long long hashTablePrimes[];
+extern const int hashTablePrimesCount;
+unsigned long long getHashTablePrime(unsigned long long n);
+
+unsigned long long primeSieveRange(unsigned long long lo, unsigned long long hi, unsigned long long *out, unsigned long long max);
 
 #endif // interface_lib_jc_h
@@ -0,0 +1,379 @@
+/**
+ * @file mphf_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação da função de hash perfeita mínima: as chaves são distribuídas por baldes e, do maior
+ * para o menor balde, procura-se o primeiro piloto que coloca todas as chaves do balde em posições livres
+ * de uma tabela com "n" posições mais 1% de folga (PTHash); no fim as chaves que ficaram na folga recebem as
+ * posições livres abaixo de "n". A pesquisa só calcula o hash da chave e lê o piloto do seu balde.
+ * @version 0.1
+ * @date 2021-06-05
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include "mphf_jc.h"
+#include "hash_known_algorithms.h"
+
+/**
+ * @brief função de mistura de 64 bits (finalizador do splitmix64) (NOTA: é uma função interna)
+ *
+ * @param x
+ * @return unsigned long long
+ */
+unsigned long long mphfMix(unsigned long long x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief função que reduz "h" ao intervalo [0, n) sem divisão (redução de Lemire) (NOTA: é uma função interna)
+ *
+ * @param h
+ * @param n
+ * @return unsigned long long
+ */
+unsigned long long mphfReduce(unsigned long long h, unsigned long long n)
+{
+#if defined(__SIZEOF_INT128__)
+    return (unsigned long long)(((unsigned __int128)h * n) >> 64);
+#else
+    // metade alta do produto 64x64 com produtos de 32 bits
+    unsigned long long hh = h >> 32, hn = n >> 32, lh = (unsigned int)h, ln = (unsigned int)n;
+    unsigned long long rm0 = hh * ln, rm1 = hn * lh, rl = lh * ln;
+    unsigned long long t = (rl >> 32) + (unsigned int)rm0 + (unsigned int)rm1;
+    return hh * hn + (rm0 >> 32) + (rm1 >> 32) + (t >> 32);
+#endif
+}
+
+// uso interno, não exportar!!!!!
+unsigned long long mphfBucket(MphfCFG *mph, unsigned long long h)
+{
+    return mphfReduce(h, mph->nbuckets);
+}
+
+// uso interno, não exportar!!!!!
+unsigned long long mphfPosition(MphfCFG *mph, unsigned long long h, unsigned int pilot)
+{
+    // o balde usa os bits altos do hash, a posição usa o hash misturado com o piloto
+    return mphfReduce(mphfMix(h ^ mphfMix(pilot + mph->seed)), mph->m);
+}
+
+/**
+ * @brief função para reservar uma estrutura vazia para "n" chaves (NOTA: é uma função interna)
+ *
+ * @param n
+ * @param m
+ * @param nbuckets
+ * @param seed
+ * @return MphfCFG*
+ */
+MphfCFG *mphfAlloc(unsigned long long n, unsigned long long m, unsigned long long nbuckets, unsigned long long seed)
+{
+    MphfCFG *mph = (MphfCFG *)malloc(sizeof(MphfCFG));
+    assert(mph);
+    mph->n = n;
+    mph->m = m;
+    mph->nbuckets = nbuckets;
+    mph->seed = seed;
+    mph->pilots = (unsigned short *)calloc(nbuckets, sizeof(unsigned short));
+    mph->remap = (unsigned long long *)calloc(m - n + 1, sizeof(unsigned long long));
+    assert(mph->pilots && mph->remap);
+    return mph;
+}
+
+/**
+ * @brief função para procurar os pilotos de todos os baldes com a semente de "mph" (NOTA: é uma função interna)
+ *
+ * @param mph
+ * @param hashes hash de 64 bits de cada chave
+ * @return true
+ * @return false se algum balde não tiver piloto de 16 bits (ou tiver chaves com o mesmo hash)
+ */
+bool mphfSearchPilots(MphfCFG *mph, const unsigned long long *hashes)
+{
+    unsigned long long n = mph->n, nb = mph->nbuckets;
+    // ordenar as chaves por balde (contagem) e os baldes por dimensão decrescente
+    unsigned long long *inicio = (unsigned long long *)calloc(nb + 1, sizeof(unsigned long long));
+    unsigned long long *chaves = (unsigned long long *)malloc(n * sizeof(unsigned long long));
+    assert(inicio && chaves);
+    for (unsigned long long i = 0; i < n; i++)
+        inicio[mphfBucket(mph, hashes[i]) + 1]++;
+    unsigned long long maior = 0;
+    for (unsigned long long b = 0; b < nb; b++)
+    {
+        if (inicio[b + 1] > maior)
+            maior = inicio[b + 1];
+        inicio[b + 1] += inicio[b];
+    }
+    unsigned long long *proximo = (unsigned long long *)malloc(nb * sizeof(unsigned long long));
+    assert(proximo);
+    memcpy(proximo, inicio, nb * sizeof(unsigned long long));
+    for (unsigned long long i = 0; i < n; i++)
+        chaves[proximo[mphfBucket(mph, hashes[i])]++] = hashes[i];
+    // baldes por dimensão: contagem por dimensão, do maior para o menor
+    unsigned long long *porDimensao = (unsigned long long *)calloc(maior + 2, sizeof(unsigned long long));
+    unsigned long long *ordem = (unsigned long long *)malloc(nb * sizeof(unsigned long long));
+    assert(porDimensao && ordem);
+    for (unsigned long long b = 0; b < nb; b++)
+        porDimensao[maior - (inicio[b + 1] - inicio[b]) + 1]++;
+    for (unsigned long long d = 0; d <= maior; d++)
+        porDimensao[d + 1] += porDimensao[d];
+    for (unsigned long long b = 0; b < nb; b++)
+        ordem[porDimensao[maior - (inicio[b + 1] - inicio[b])]++] = b;
+
+    unsigned long long *ocupadas = (unsigned long long *)calloc((mph->m + 63) / 64, sizeof(unsigned long long));
+    unsigned long long *pos = (unsigned long long *)malloc((maior ? maior : 1) * sizeof(unsigned long long));
+    assert(ocupadas && pos);
+    bool ok = true;
+    for (unsigned long long k = 0; ok && k < nb; k++)
+    {
+        unsigned long long b = ordem[k];
+        unsigned long long tam = inicio[b + 1] - inicio[b];
+        if (tam == 0)
+            break;
+        const unsigned long long *hb = chaves + inicio[b];
+        unsigned int pilot = 0;
+        for (; pilot <= 0xFFFF; pilot++)
+        {
+            unsigned long long j = 0;
+            for (; j < tam; j++)
+            {
+                pos[j] = mphfPosition(mph, hb[j], pilot);
+                if (ocupadas[pos[j] >> 6] & (1ULL << (pos[j] & 63)))
+                    break;
+                // marcar já, para detetar duas chaves do balde na mesma posição
+                ocupadas[pos[j] >> 6] |= 1ULL << (pos[j] & 63);
+            }
+            if (j == tam)
+                break;
+            // desfazer as marcas deste piloto
+            while (j > 0)
+            {
+                j--;
+                ocupadas[pos[j] >> 6] &= ~(1ULL << (pos[j] & 63));
+            }
+        }
+        if (pilot > 0xFFFF)
+            ok = false;
+        else
+            mph->pilots[b] = (unsigned short)pilot;
+    }
+    // as posições ocupadas acima de n recebem, por ordem, as posições livres abaixo de n (tornar a função mínima)
+    unsigned long long livre = 0;
+    for (unsigned long long p = n; ok && p < mph->m; p++)
+    {
+        if (!(ocupadas[p >> 6] & (1ULL << (p & 63))))
+            continue;
+        while (ocupadas[livre >> 6] & (1ULL << (livre & 63)))
+            livre++;
+        mph->remap[p - n] = livre++;
+    }
+    free(pos);
+    free(ocupadas);
+    free(ordem);
+    free(porDimensao);
+    free(proximo);
+    free(chaves);
+    free(inicio);
+    return ok;
+}
+
+/**
+ * @brief função para construir a função de hash perfeita mínima de "n" chaves binárias distintas
+ *
+ * @param keys
+ * @param lengths
+ * @param n
+ * @return MphfCFG* ou NULL se não foi possível (chaves repetidas)
+ */
+MphfCFG *newMphf(const void **keys, const unsigned int *lengths, size_t n)
+{
+    assert(keys && lengths);
+    unsigned long long nb = (unsigned long long)n / MPHF_LAMBDA + 1;
+    unsigned long long m = (unsigned long long)n + (unsigned long long)n * MPHF_SLACK_PERCENT / 100 + 1;
+    for (unsigned long long s = 0; s < MPHF_MAX_SEEDS; s++)
+    {
+        MphfCFG *mph = mphfAlloc((unsigned long long)n, m, nb, mphfMix(s + 0x9E3779B97F4A7C15ULL));
+        unsigned long long *hashes = (unsigned long long *)malloc((n + 1) * sizeof(unsigned long long));
+        assert(hashes);
+        for (size_t i = 0; i < n; i++)
+            hashes[i] = WYHash64Seed((const char *)keys[i], lengths[i], mph->seed);
+        bool ok = mphfSearchPilots(mph, hashes);
+        free(hashes);
+        if (ok)
+            return mph;
+        destroyMphf(mph);
+    }
+    return NULL;
+}
+
+/**
+ * @brief função para construir a função de hash perfeita mínima de "n" strings distintas
+ *
+ * @param keys
+ * @param n
+ * @return MphfCFG* ou NULL se não foi possível (strings repetidas)
+ */
+MphfCFG *newMphfStrings(char **keys, size_t n)
+{
+    unsigned int *lengths = (unsigned int *)malloc((n + 1) * sizeof(unsigned int));
+    assert(lengths);
+    for (size_t i = 0; i < n; i++)
+        lengths[i] = (unsigned int)strlen(keys[i]);
+    MphfCFG *mph = newMphf((const void **)keys, lengths, n);
+    free(lengths);
+    return mph;
+}
+
+/**
+ * @brief função para construir a função de hash perfeita mínima com as chaves de uma hashtable terminada
+ * (o índice de cada chave não segue nenhuma ordem da hashtable, ver mphfLookup)
+ *
+ * @param ht
+ * @return MphfCFG*
+ */
+MphfCFG *newMphfFromHashTable(HashTableCFG *ht)
+{
+    assert(ht);
+    size_t n = 0;
+    const void **keys = (const void **)malloc((ht->totalItems + 1) * sizeof(void *));
+    unsigned int *lengths = (unsigned int *)malloc((ht->totalItems + 1) * sizeof(unsigned int));
+    assert(keys && lengths);
+    for (int t = 0; t < 2; t++)
+    {
+        NodoHashTable **rows = t == 0 ? ht->hashtable : ht->oldHashtable;
+        size_t m = t == 0 ? ht->M : ht->oldM;
+        for (size_t i = 0; rows && i < m; i++)
+        {
+            for (NodoHashTable *nodo = rows[i]; nodo; nodo = nodo->next)
+            {
+                keys[n] = htNodoKey(ht, nodo);
+                lengths[n++] = nodo->length;
+            }
+        }
+    }
+    MphfCFG *mph = newMphf(keys, lengths, n);
+    free(lengths);
+    free(keys);
+    return mph;
+}
+
+/**
+ * @brief função para destruir a estrutura
+ *
+ * @param mph
+ * @return MphfCFG*
+ */
+MphfCFG *destroyMphf(MphfCFG *mph)
+{
+    assert(mph);
+    free(mph->pilots);
+    free(mph->remap);
+    free(mph);
+    return NULL;
+}
+
+/**
+ * @brief função que devolve o índice (0..n-1) de uma chave do conjunto: um hash e uma leitura do piloto
+ * (e, para ~1% das chaves, uma leitura de "remap")
+ *
+ * @param mph
+ * @param key
+ * @param length
+ * @return unsigned long long
+ */
+unsigned long long mphfLookup(MphfCFG *mph, const void *key, unsigned int length)
+{
+    assert(mph);
+    unsigned long long h = WYHash64Seed((const char *)key, length, mph->seed);
+    unsigned long long p = mphfPosition(mph, h, mph->pilots[mphfBucket(mph, h)]);
+    return p < mph->n ? p : mph->remap[p - mph->n];
+}
+
+/**
+ * @brief função que devolve o índice (0..n-1) de uma string do conjunto
+ *
+ * @param mph
+ * @param v
+ * @return unsigned long long
+ */
+unsigned long long mphfLookupString(MphfCFG *mph, char *v)
+{
+    return mphfLookup(mph, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief função que devolve a dimensão da estrutura em bits (pilotos + remap + campos)
+ *
+ * @param mph
+ * @return unsigned long long
+ */
+unsigned long long mphfSizeBits(MphfCFG *mph)
+{
+    assert(mph);
+    return 8 * (sizeof(MphfCFG) + mph->nbuckets * sizeof(unsigned short) + (mph->m - mph->n) * sizeof(unsigned long long));
+}
+
+/**
+ * @brief função para gravar a estrutura num ficheiro: MPHF_MAGIC, n, m, nbuckets, seed, os pilotos e o "remap"
+ * (ordem de bytes da máquina que grava)
+ *
+ * @param mph
+ * @param path
+ * @return true
+ * @return false se não foi possível escrever o ficheiro
+ */
+bool mphfSave(MphfCFG *mph, const char *path)
+{
+    assert(mph);
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return false;
+    unsigned long long campos[4] = {mph->n, mph->m, mph->nbuckets, mph->seed};
+    bool ok = fwrite(MPHF_MAGIC, 8, 1, f) == 1
+              && fwrite(campos, sizeof(campos), 1, f) == 1
+              && fwrite(mph->pilots, sizeof(unsigned short), mph->nbuckets, f) == mph->nbuckets
+              && fwrite(mph->remap, sizeof(unsigned long long), mph->m - mph->n, f) == mph->m - mph->n;
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
+}
+
+/**
+ * @brief função para ler uma estrutura gravada com mphfSave
+ *
+ * @param path
+ * @return MphfCFG* ou NULL se o ficheiro não existir ou for inválido
+ */
+MphfCFG *mphfLoad(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    char magic[8];
+    unsigned long long campos[4];
+    if (fread(magic, 8, 1, f) != 1 || memcmp(magic, MPHF_MAGIC, 8) != 0
+        || fread(campos, sizeof(campos), 1, f) != 1
+        || campos[1] <= campos[0] || campos[1] - campos[0] > campos[0] + 1
+        || campos[2] == 0 || campos[2] > campos[0] + 1)
+    {
+        fclose(f);
+        return NULL;
+    }
+    MphfCFG *mph = mphfAlloc(campos[0], campos[1], campos[2], campos[3]);
+    if (fread(mph->pilots, sizeof(unsigned short), mph->nbuckets, f) != mph->nbuckets
+        || fread(mph->remap, sizeof(unsigned long long), mph->m - mph->n, f) != mph->m - mph->n)
+        mph = destroyMphf(mph);
+    fclose(f);
+    return mph;
+}
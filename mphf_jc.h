@@ -0,0 +1,62 @@
+/**
+ * @file mphf_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface de uma função de hash perfeita mínima (estilo CHD/PTHash) para conjuntos de chaves estáticos.
+ * Cada uma das "n" chaves do conjunto recebe um índice distinto em [0, n), calculado com um único acesso
+ * a um array de "pilotos" (16 bits por balde, cerca de 4 bits por chave); as chaves colocadas nas ~1% posições
+ * extra (acima de n) passam por uma segunda leitura ("remap"). Os dados ficam num array do utilizador
+ * indexado pelo resultado. Uma chave que não pertence ao conjunto devolve um índice qualquer.
+ * @version 0.1
+ * @date 2021-06-05
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_MPHF_JC_H
+#define INC_14AED2HASH_MPHF_JC_H
+
+#include <stdbool.h>
+#include "hashtable_jc.h"
+
+#define MPHF_MAGIC "JCMPHF01"
+
+/**
+ * @brief número médio de chaves por balde (cada balde guarda um piloto de 16 bits)
+ */
+#define MPHF_LAMBDA 4
+
+/**
+ * @brief posições extra por cada 100 chaves: com a tabela 100% cheia os últimos baldes precisariam de
+ * pilotos da ordem de "n", com 1% de folga chegam 16 bits
+ */
+#define MPHF_SLACK_PERCENT 1
+
+/**
+ * @brief número de sementes experimentadas antes de desistir (um piloto não cabe em 16 bits ou chaves repetidas)
+ */
+#define MPHF_MAX_SEEDS 16
+
+typedef struct mphfcfg MphfCFG;
+struct mphfcfg {
+    unsigned long long n;           /**< número de chaves (índices de 0 a n-1). */
+    unsigned long long m;           /**< posições da tabela usada na construção (n + folga). */
+    unsigned long long nbuckets;    /**< número de baldes. */
+    unsigned long long seed;        /**< semente do hash das chaves. */
+    unsigned short *pilots;         /**< piloto de cada balde (desloca as posições das chaves do balde). */
+    unsigned long long *remap;      /**< índice final das chaves colocadas nas posições n..m-1. */
+};
+
+MphfCFG *newMphf(const void **keys, const unsigned int *lengths, size_t n);
+MphfCFG *newMphfStrings(char **keys, size_t n);
+MphfCFG *newMphfFromHashTable(HashTableCFG *ht);
+MphfCFG *destroyMphf(MphfCFG *mph);
+
+unsigned long long mphfLookup(MphfCFG *mph, const void *key, unsigned int length);
+unsigned long long mphfLookupString(MphfCFG *mph, char *v);
+unsigned long long mphfSizeBits(MphfCFG *mph);
+
+bool mphfSave(MphfCFG *mph, const char *path);
+MphfCFG *mphfLoad(const char *path);
+
+#endif //INC_14AED2HASH_MPHF_JC_H
@@ -0,0 +1,354 @@
+/**
+ * @file robinhood_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação de uma hashtable de endereçamento aberto com "Robin Hood hashing" sem o tipo de dados definido.
+ * A sondagem é linear; como as distâncias ao longo de uma sequência nunca saltam mais do que uma unidade,
+ * uma pesquisa sem sucesso pára na primeira posição com distância menor do que a da chave procurada.
+ * @version 0.1
+ * @date 2021-06-03
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include "robinhood_jc.h"
+
+// uso interno, não exportar!!!!!
+bool rhSlotKeyEquals(RobinHoodCFG *rh, RobinHoodSlot *slot, const void *key, unsigned int length)
+{
+    unsigned int l = slot->length;
+    const void *k = rh->getKey ? rh->getKey(slot->data, &l) : rh->getString(slot->data);
+    if (rh->keyEquals)
+        return rh->keyEquals(k, l, key, length);
+    return memcmp(k, key, length) == 0;
+}
+
+/**
+ * @brief função para calcular a capacidade (potência de 2) necessária para "m" itens (NOTA: é uma função interna)
+ *
+ * @param m
+ * @return size_t
+ */
+size_t rhCapacity(size_t m)
+{
+    size_t cap = 16;
+    while (cap * RH_MAX_LOAD_NUM / RH_MAX_LOAD_DEN < m)
+    {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+/**
+ * @brief procedimento para reservar a memória de uma tabela vazia com "cap" posições (NOTA: é um procedimento interno)
+ *
+ * @param rh
+ * @param cap
+ */
+void rhAllocTable(RobinHoodCFG *rh, size_t cap)
+{
+    rh->M = cap;
+    rh->slots = (RobinHoodSlot *)malloc(cap * sizeof(RobinHoodSlot));
+    assert(rh->slots);
+    for (size_t i = 0; i < cap; i++)
+    {
+        rh->slots[i].dist = RH_DIST_EMPTY;
+    }
+    rh->growthLeft = cap * RH_MAX_LOAD_NUM / RH_MAX_LOAD_DEN - rh->totalItems;
+}
+
+/**
+ * @brief função para colocar uma posição na tabela, desalojando as posições mais perto da sua posição ideal (NOTA: é uma função interna)
+ *
+ * @param rh
+ * @param novo posição a colocar (a distância é recalculada)
+ * @return RobinHoodSlot* onde ficou "novo"
+ */
+RobinHoodSlot *rhPlace(RobinHoodCFG *rh, RobinHoodSlot novo)
+{
+    size_t mask = rh->M - 1;
+    size_t i = novo.hash & mask;
+    RobinHoodSlot *colocado = NULL;
+    novo.dist = 0;
+    for (;; i = (i + 1) & mask, novo.dist++)
+    {
+        RobinHoodSlot *slot = rh->slots + i;
+        if (slot->dist == RH_DIST_EMPTY)
+        {
+            (*slot) = novo;
+            return colocado ? colocado : slot;
+        }
+        if (slot->dist < novo.dist)
+        {
+            // o "rico" (mais perto da posição ideal) cede o lugar e continua a sondagem
+            RobinHoodSlot tmp = *slot;
+            (*slot) = novo;
+            novo = tmp;
+            if (!colocado)
+                colocado = slot;
+        }
+    }
+}
+
+/**
+ * @brief procedimento para duplicar a tabela e voltar a colocar todos os dados (NOTA: é um procedimento interno)
+ * o hash está guardado em cada posição, não é preciso voltar às chaves
+ *
+ * @param rh
+ */
+void rhGrow(RobinHoodCFG *rh)
+{
+    RobinHoodSlot *old = rh->slots;
+    size_t oldM = rh->M;
+    rhAllocTable(rh, oldM * 2);
+    for (size_t i = 0; i < oldM; i++)
+    {
+        if (old[i].dist != RH_DIST_EMPTY)
+            rhPlace(rh, old[i]);
+    }
+    free(old);
+    rh->lastFound = NULL;
+}
+
+/**
+ * @brief função para procurar a chave com o hash (misturado) "h" (NOTA: é uma função interna)
+ *
+ * @param rh
+ * @param key
+ * @param length
+ * @param h
+ * @return RobinHoodSlot* ou NULL se não existir
+ */
+RobinHoodSlot *rhFindSlot(RobinHoodCFG *rh, const void *key, unsigned int length, unsigned int h)
+{
+    size_t mask = rh->M - 1;
+    size_t i = h & mask;
+    for (size_t d = 0;; i = (i + 1) & mask, d++)
+    {
+        RobinHoodSlot *slot = rh->slots + i;
+        // se a chave existisse já teria desalojado esta posição
+        if (slot->dist == RH_DIST_EMPTY || slot->dist < d)
+            return NULL;
+        if (slot->hash == h && slot->length == length && rhSlotKeyEquals(rh, slot, key, length))
+            return slot;
+    }
+}
+
+/**
+ * @brief função para destruir a tabela e os dados
+ *
+ * @param rh
+ * @return RobinHoodCFG*
+ */
+RobinHoodCFG *destroyRobinHoodTable(RobinHoodCFG *rh)
+{
+    assert(rh);
+    for (size_t i = 0; i < rh->M; i++)
+    {
+        if (rh->slots[i].dist != RH_DIST_EMPTY)
+            rh->destroy(rh->slots[i].data);
+    }
+    free(rh->slots);
+    free(rh);
+    return NULL;
+}
+
+/**
+ * @brief função para inserir dados na tabela, se já existirem incrementa o contador da posição
+ *
+ * @param rh
+ * @param data
+ * @return true
+ * @return false
+ */
+bool rhInsertData(RobinHoodCFG *rh, void *data)
+{
+    assert(rh);
+    unsigned int length;
+    const void *key = htKeyOf(rh->getKey, rh->getString, data, &length);
+    // a posição ideal usa os bits mais baixos do hash, que as funções mais simples distribuem mal
+    unsigned int h = htMix(rh->hash((const char *)key, length));
+    RobinHoodSlot *slot = rhFindSlot(rh, key, length, h);
+    rh->lastFound = slot;
+    if (slot)
+    {
+        slot->count++;
+        return false;
+    }
+    if (rh->growthLeft == 0)
+        rhGrow(rh);
+    RobinHoodSlot novo;
+    novo.data = data;
+    novo.hash = h;
+    novo.length = length;
+    novo.count = 0;
+    rh->lastFound = rhPlace(rh, novo);
+    rh->totalItems++;
+    rh->growthLeft--;
+    rh->nextDataID++;
+    return true;
+}
+
+/**
+ * @brief função para verificar se existe uma chave binária com "length" bytes na tabela
+ *
+ * @param rh
+ * @param key
+ * @param length
+ * @return true
+ * @return false
+ */
+bool rhExistKey(RobinHoodCFG *rh, const void *key, unsigned int length)
+{
+    assert(rh);
+    rh->lastFound = rhFindSlot(rh, key, length, htMix(rh->hash((const char *)key, length)));
+    return rh->lastFound ? true : false;
+}
+
+/**
+ * @brief função para verificar se existe uma string na tabela
+ *
+ * @param rh
+ * @param v
+ * @return true
+ * @return false
+ */
+bool rhExistString(RobinHoodCFG *rh, char *v)
+{
+    return rhExistKey(rh, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief função para remover uma chave binária da tabela, os dados são libertados com "destroy"
+ * as posições seguintes da mesma sequência recuam uma posição ("backward shift"), assim não ficam
+ * marcas de posição apagada e as distâncias continuam exatas
+ *
+ * @param rh
+ * @param key
+ * @param length
+ * @return true
+ * @return false se a chave não existir
+ */
+bool rhRemoveKey(RobinHoodCFG *rh, const void *key, unsigned int length)
+{
+    assert(rh);
+    assert(rh->destroy);
+    RobinHoodSlot *slot = rhFindSlot(rh, key, length, htMix(rh->hash((const char *)key, length)));
+    rh->lastFound = NULL;
+    if (!slot)
+        return false;
+    rh->destroy(slot->data);
+    size_t mask = rh->M - 1;
+    size_t i = (size_t)(slot - rh->slots);
+    size_t j = (i + 1) & mask;
+    // termina numa posição vazia ou numa chave que já está na posição ideal
+    while (rh->slots[j].dist != RH_DIST_EMPTY && rh->slots[j].dist > 0)
+    {
+        rh->slots[i] = rh->slots[j];
+        rh->slots[i].dist--;
+        i = j;
+        j = (j + 1) & mask;
+    }
+    rh->slots[i].dist = RH_DIST_EMPTY;
+    rh->totalItems--;
+    rh->growthLeft++;
+    return true;
+}
+
+/**
+ * @brief função para remover uma string da tabela, os dados são libertados com "destroy"
+ *
+ * @param rh
+ * @param v
+ * @return true
+ * @return false se a string não existir
+ */
+bool rhRemoveString(RobinHoodCFG *rh, char *v)
+{
+    return rhRemoveKey(rh, v, (unsigned int)strlen(v));
+}
+
+/**
+ * @brief procedimento para calcular os dados estatisticos com os mesmos campos de htStatsCalc:
+ * StatsMax/StatsMin = maior/menor comprimento da sondagem de uma chave presente, EmptyRow = posições vazias,
+ * ColisionsMax/ColisionsMin = maior/menor contador de uma chave presente
+ *
+ * @param rh
+ */
+void rhStatsCalc(RobinHoodCFG *rh)
+{
+    assert(rh);
+    rh->StatsMax = rh->StatsMin = rh->ColisionsMax = rh->ColisionsMin = 0;
+    rh->EmptyRow = 0;
+    bool primeiro = true;
+    for (size_t i = 0; i < rh->M; i++)
+    {
+        RobinHoodSlot *slot = rh->slots + i;
+        if (slot->dist == RH_DIST_EMPTY)
+        {
+            rh->EmptyRow++;
+            continue;
+        }
+        size_t sondagem = slot->dist + 1;
+        if (primeiro || sondagem > rh->StatsMax)
+            rh->StatsMax = sondagem;
+        if (primeiro || sondagem < rh->StatsMin)
+            rh->StatsMin = sondagem;
+        if (primeiro || slot->count > rh->ColisionsMax)
+            rh->ColisionsMax = slot->count;
+        if (primeiro || slot->count < rh->ColisionsMin)
+            rh->ColisionsMin = slot->count;
+        primeiro = false;
+    }
+}
+
+/**
+ * @brief função para inicializar uma tabela com capacidade para (pelo menos) "m" itens sem crescer
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gs
+ * @return RobinHoodCFG*
+ */
+RobinHoodCFG *newRobinHoodTable(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+{
+    assert(fh);
+    RobinHoodCFG *novo = (RobinHoodCFG *)malloc(sizeof(RobinHoodCFG));
+    assert(novo);
+    novo->totalItems = 0;
+    novo->nextDataID = 1;
+    novo->StatsMax = novo->StatsMin = novo->ColisionsMax = novo->ColisionsMin = 0;
+    novo->EmptyRow = 0;
+    novo->hash = fh;
+    novo->getString = gs;
+    novo->getKey = NULL;
+    novo->keyEquals = NULL;
+    novo->destroy = dd;
+    novo->lastFound = NULL;
+    rhAllocTable(novo, rhCapacity(m));
+    return novo;
+}
+
+/**
+ * @brief função para inicializar uma tabela com chaves binárias (apontador + comprimento)
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gk função que devolve a chave e o respetivo comprimento dos dados
+ * @param eq função de igualdade das chaves (NULL = comparar os bytes com "memcmp")
+ * @return RobinHoodCFG*
+ */
+RobinHoodCFG *newRobinHoodTableKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq)
+{
+    assert(gk);
+    RobinHoodCFG *novo = newRobinHoodTable(m, fh, dd, NULL);
+    novo->getKey = gk;
+    novo->keyEquals = eq;
+    return novo;
+}
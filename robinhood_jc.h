@@ -0,0 +1,79 @@
+/**
+ * @file robinhood_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface de uma hashtable de endereçamento aberto com "Robin Hood hashing" sem o tipo de dados definido.
+ * Cada posição guarda a distância à sua posição ideal; na inserção quem está mais perto da posição ideal cede o lugar,
+ * o que mantém a variância do comprimento das sondagens baixa. As pesquisas sem sucesso terminam mais cedo e as
+ * remoções usam "backward shift" (sem marcas de posição apagada).
+ * Usa o mesmo modelo de callbacks da hashtable com listas ("hashtable_jc.h").
+ * @version 0.1
+ * @date 2021-06-03
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_ROBINHOOD_JC_H
+#define INC_14AED2HASH_ROBINHOOD_JC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hashtable_jc.h"
+#include "hash_known_algorithms.h"
+
+/**
+ * @brief fator de carga máximo (9/10) a partir do qual a tabela duplica
+ */
+#define RH_MAX_LOAD_NUM 9
+#define RH_MAX_LOAD_DEN 10
+
+/**
+ * @brief distância guardada nas posições vazias
+ */
+#define RH_DIST_EMPTY SIZE_MAX
+
+/**
+ * @brief cada posição da tabela
+ */
+typedef struct robinhoodslot RobinHoodSlot;
+struct robinhoodslot {
+    void *data;             /**< apontador para os dados do utilizador. */
+    unsigned int hash;      /**< hash completo (misturado) da chave. */
+    unsigned int length;    /**< comprimento da chave. */
+    size_t dist;                /**< distância à posição ideal (RH_DIST_EMPTY = posição vazia). */
+    unsigned long long count;   /**< número de vezes que os dados foram inseridos novamente. */
+};
+
+/**
+ * @brief estrutura de configuração da tabela Robin Hood
+ */
+typedef struct robinhoodcfg RobinHoodCFG;
+struct robinhoodcfg {
+    size_t M;                               /**< número de posições (potência de 2). */
+    size_t totalItems;                      /**< total de itens guardados. */
+    size_t growthLeft;                      /**< inserções possíveis até ser necessário crescer. */
+    unsigned long long nextDataID;          /**< próximo ID (igual ao "nextDataID" da hashtable_jc). */
+    size_t StatsMax, StatsMin;              /**< maior/menor comprimento da sondagem (distância + 1) de uma chave presente. */
+    unsigned long long ColisionsMax, ColisionsMin; /**< maior/menor contador de uma chave presente. */
+    size_t EmptyRow;                        /**< posições vazias. */
+    RobinHoodSlot *slots;                   /**< posições. */
+    RobinHoodSlot *lastFound;               /**< posição encontrada na última pesquisa (inválida depois de inserir/remover). */
+    TfuncHashKnownAlgorithm hash;           /**< função de hash completa (ver "hash_known_algorithms.h"). */
+    TfuncHashTableGetString getString;      /**< função que devolve a string dos dados (ou NULL). */
+    TfuncHashTableGetKey getKey;            /**< função que devolve a chave binária dos dados (ou NULL). */
+    TfuncHashTableKeyEquals keyEquals;      /**< igualdade das chaves binárias (NULL = memcmp). */
+    TfuncHashTableDestroyData destroy;      /**< procedimento para libertar os dados. */
+};
+
+RobinHoodCFG *newRobinHoodTable(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+RobinHoodCFG *newRobinHoodTableKey(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetKey gk, TfuncHashTableKeyEquals eq);
+RobinHoodCFG *destroyRobinHoodTable(RobinHoodCFG *rh);
+
+bool rhInsertData(RobinHoodCFG *rh, void *data);
+bool rhExistString(RobinHoodCFG *rh, char *v);
+bool rhExistKey(RobinHoodCFG *rh, const void *key, unsigned int length);
+bool rhRemoveString(RobinHoodCFG *rh, char *v);
+bool rhRemoveKey(RobinHoodCFG *rh, const void *key, unsigned int length);
+void rhStatsCalc(RobinHoodCFG *rh);
+
+#endif //INC_14AED2HASH_ROBINHOOD_JC_H
@@ -0,0 +1,374 @@
+/**
+ * @file swisstable_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação de uma hashtable de endereçamento aberto (estilo "Swiss table") sem o tipo de dados definido.
+ * Cada posição tem um byte de controlo com 7 bits do hash, os bytes de controlo são comparados 16 de cada vez
+ * (SSE2, quando disponível) e só as posições candidatas obrigam a ler os dados do utilizador.
+ * @version 0.1
+ * @date 2021-05-20
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "swisstable_jc.h"
+
+/**
+ * @brief função que devolve a máscara das posições do grupo cujo byte de controlo é igual a "c" (NOTA: é uma função interna)
+ *
+ * @param g
+ * @param c
+ * @return unsigned int
+ */
+unsigned int swGroupMatch(const signed char *g, signed char c)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(c), ctrl));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < SW_GROUP_WIDTH; i++)
+    {
+        if (g[i] == c)
+            mask |= 1U << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief função que devolve a máscara das posições vazias do grupo (NOTA: é uma função interna)
+ *
+ * @param g
+ * @return unsigned int
+ */
+unsigned int swGroupMatchEmpty(const signed char *g)
+{
+    return swGroupMatch(g, SW_CTRL_EMPTY);
+}
+
+/**
+ * @brief função que devolve a máscara das posições livres do grupo, vazias ou apagadas (NOTA: é uma função interna)
+ *
+ * @param g
+ * @return unsigned int
+ */
+unsigned int swGroupMatchEmptyOrDeleted(const signed char *g)
+{
+#if defined(__SSE2__)
+    // as posições ocupadas guardam 0..127, só as vazias e as apagadas têm o bit de sinal ligado
+    return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+#else
+    return swGroupMatch(g, SW_CTRL_EMPTY) | swGroupMatch(g, SW_CTRL_DELETED);
+#endif
+}
+
+/**
+ * @brief função para calcular a capacidade (potência de 2) necessária para "m" itens (NOTA: é uma função interna)
+ *
+ * @param m
+ * @return size_t
+ */
+size_t swCapacity(size_t m)
+{
+    size_t cap = SW_GROUP_WIDTH;
+    while (cap / SW_MAX_LOAD_DEN * SW_MAX_LOAD_NUM < m)
+    {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+/**
+ * @brief procedimento para reservar a memória de uma tabela vazia com "cap" posições (NOTA: é um procedimento interno)
+ *
+ * @param sw
+ * @param cap
+ */
+void swAllocTable(SwissTableCFG *sw, size_t cap)
+{
+    sw->M = cap;
+    sw->ctrl = (signed char *)malloc(cap);
+    assert(sw->ctrl);
+    memset(sw->ctrl, SW_CTRL_EMPTY, cap);
+    sw->slots = (SwissTableSlot *)malloc(cap * sizeof(SwissTableSlot));
+    assert(sw->slots);
+    sw->growthLeft = cap / SW_MAX_LOAD_DEN * SW_MAX_LOAD_NUM - sw->totalItems;
+}
+
+/**
+ * @brief função que devolve o primeiro grupo da sequência de sondagem do hash "h" (NOTA: é uma função interna)
+ * os 7 bits mais baixos ficam para o byte de controlo, por isso o grupo usa os 25 bits seguintes; com mais de 2^25 grupos
+ * os bits mais baixos voltam a entrar (rotação), senão metade dos grupos nunca seria a primeira escolha de nenhuma chave
+ *
+ * @param sw
+ * @param h
+ * @return size_t
+ */
+size_t swGroupStart(SwissTableCFG *sw, unsigned int h)
+{
+    return ((size_t)(h >> 7) | ((size_t)h << 25)) & (sw->M / SW_GROUP_WIDTH - 1);
+}
+
+/**
+ * @brief função que devolve a primeira posição livre (vazia ou apagada) na sequência de sondagem do hash "h" (NOTA: é uma função interna)
+ *
+ * @param sw
+ * @param h
+ * @return size_t
+ */
+size_t swFindFreeSlot(SwissTableCFG *sw, unsigned int h)
+{
+    size_t gmask = sw->M / SW_GROUP_WIDTH - 1;
+    size_t g = swGroupStart(sw, h);
+    for (size_t i = 1;; i++)
+    {
+        unsigned int mask = swGroupMatchEmptyOrDeleted(sw->ctrl + g * SW_GROUP_WIDTH);
+        if (mask)
+            return g * SW_GROUP_WIDTH + (size_t)__builtin_ctz(mask);
+        // sondagem triangular: visita todos os grupos porque o número de grupos é potência de 2
+        g = (g + i) & gmask;
+    }
+}
+
+/**
+ * @brief procedimento para refazer a tabela quando já não há posições livres: duplica a tabela ou, se pelo menos
+ * metade da capacidade está ocupada por posições apagadas, mantém a dimensão e só limpa as posições apagadas
+ * (NOTA: é um procedimento interno)
+ *
+ * @param sw
+ */
+void swGrow(SwissTableCFG *sw)
+{
+    signed char *oldCtrl = sw->ctrl;
+    SwissTableSlot *oldSlots = sw->slots;
+    size_t oldM = sw->M;
+    swAllocTable(sw, sw->totalItems <= oldM / SW_MAX_LOAD_DEN * SW_MAX_LOAD_NUM / 2 ? oldM : oldM * 2);
+    for (size_t i = 0; i < oldM; i++)
+    {
+        if (oldCtrl[i] >= 0)
+        {
+            char *s = sw->getString(oldSlots[i].data);
+            unsigned int h = htMix(sw->hash(s, (unsigned int)strlen(s)));
+            size_t pos = swFindFreeSlot(sw, h);
+            sw->ctrl[pos] = (signed char)(h & 0x7F);
+            sw->slots[pos] = oldSlots[i];
+        }
+    }
+    free(oldCtrl);
+    free(oldSlots);
+    sw->lastFound = NULL;
+}
+
+/**
+ * @brief função para procurar a string "v" com o hash "h" (NOTA: é uma função interna)
+ *
+ * @param sw
+ * @param v
+ * @param h
+ * @param grupos devolve o número de grupos visitados (pode ser NULL)
+ * @return SwissTableSlot* ou NULL se não existir
+ */
+SwissTableSlot *swFindSlot(SwissTableCFG *sw, char *v, unsigned int h, size_t *grupos)
+{
+    size_t gmask = sw->M / SW_GROUP_WIDTH - 1;
+    size_t g = swGroupStart(sw, h);
+    signed char h2 = (signed char)(h & 0x7F);
+    for (size_t i = 1;; i++)
+    {
+        const signed char *ctrl = sw->ctrl + g * SW_GROUP_WIDTH;
+        unsigned int mask = swGroupMatch(ctrl, h2);
+        while (mask)
+        {
+            SwissTableSlot *slot = sw->slots + g * SW_GROUP_WIDTH + __builtin_ctz(mask);
+            if (strcmp(sw->getString(slot->data), v) == 0)
+            {
+                if (grupos)
+                    (*grupos) = i;
+                return slot;
+            }
+            mask &= mask - 1;
+        }
+        // um grupo com posições vazias termina a sequência de sondagem
+        if (swGroupMatchEmpty(ctrl))
+        {
+            if (grupos)
+                (*grupos) = i;
+            return NULL;
+        }
+        g = (g + i) & gmask;
+    }
+}
+
+/**
+ * @brief função para destruir a tabela e os dados
+ *
+ * @param sw
+ * @return SwissTableCFG*
+ */
+SwissTableCFG *destroySwissTable(SwissTableCFG *sw)
+{
+    assert(sw);
+    for (size_t i = 0; i < sw->M; i++)
+    {
+        if (sw->ctrl[i] >= 0)
+            sw->destroy(sw->slots[i].data);
+    }
+    free(sw->ctrl);
+    free(sw->slots);
+    free(sw);
+    return NULL;
+}
+
+/**
+ * @brief função para inserir dados na tabela, se já existirem incrementa o contador da posição
+ *
+ * @param sw
+ * @param data
+ * @return true
+ * @return false
+ */
+bool swInsertData(SwissTableCFG *sw, void *data)
+{
+    assert(sw);
+    assert(sw->hash);
+    char *s = sw->getString(data);
+    // as funções mais simples espalham mal os bits (7 vão para o controlo e os restantes para a posição)
+    unsigned int h = htMix(sw->hash(s, (unsigned int)strlen(s)));
+    SwissTableSlot *slot = swFindSlot(sw, s, h, NULL);
+    sw->lastFound = slot;
+    if (slot)
+    {
+        slot->count++;
+        return false;
+    }
+    size_t pos = swFindFreeSlot(sw, h);
+    // reaproveitar uma posição apagada não gasta a margem de crescimento (já foi gasta quando foi ocupada)
+    if (sw->ctrl[pos] == SW_CTRL_EMPTY)
+    {
+        if (sw->growthLeft == 0)
+        {
+            swGrow(sw);
+            pos = swFindFreeSlot(sw, h);
+        }
+        sw->growthLeft--;
+    }
+    sw->ctrl[pos] = (signed char)(h & 0x7F);
+    sw->slots[pos].data = data;
+    sw->slots[pos].count = 0;
+    sw->lastFound = sw->slots + pos;
+    sw->totalItems++;
+    sw->nextDataID++;
+    return true;
+}
+
+/**
+ * @brief função para remover da tabela a string "v", os dados são libertados com "destroy".
+ * A posição fica marcada como apagada (SW_CTRL_DELETED) para não interromper as sequências de sondagem que passam
+ * por ela; se o grupo ainda tem posições vazias nenhuma sequência passou para além dele e a posição volta a vazia
+ *
+ * @param sw
+ * @param v
+ * @return true
+ * @return false se a string não existir
+ */
+bool swRemoveString(SwissTableCFG *sw, char *v)
+{
+    assert(sw);
+    assert(sw->hash);
+    SwissTableSlot *slot = swFindSlot(sw, v, htMix(sw->hash(v, (unsigned int)strlen(v))), NULL);
+    sw->lastFound = NULL;
+    if (!slot)
+        return false;
+    size_t pos = (size_t)(slot - sw->slots);
+    // um grupo que nunca encheu desde o último "swGrow" não fez nenhuma chave continuar para o grupo seguinte
+    if (swGroupMatchEmpty(sw->ctrl + pos / SW_GROUP_WIDTH * SW_GROUP_WIDTH))
+    {
+        sw->ctrl[pos] = SW_CTRL_EMPTY;
+        sw->growthLeft++;
+    }
+    else
+    {
+        sw->ctrl[pos] = SW_CTRL_DELETED;
+    }
+    sw->destroy(slot->data);
+    slot->data = NULL;
+    sw->totalItems--;
+    return true;
+}
+
+/**
+ * @brief função para verificar se existe uma string na tabela
+ *
+ * @param sw
+ * @param v
+ * @return true
+ * @return false
+ */
+bool swExistString(SwissTableCFG *sw, char *v)
+{
+    assert(sw);
+    assert(sw->hash);
+    sw->lastFound = swFindSlot(sw, v, htMix(sw->hash(v, (unsigned int)strlen(v))), NULL);
+    return sw->lastFound ? true : false;
+}
+
+/**
+ * @brief procedimento para calcular os dados estatisticos (grupos visitados por cada chave e grupos vazios)
+ *
+ * @param sw
+ */
+void swStatsCalc(SwissTableCFG *sw)
+{
+    assert(sw);
+    sw->StatsMax = sw->StatsMin = sw->EmptyGroups = 0;
+    for (size_t g = 0; g < sw->M; g += SW_GROUP_WIDTH)
+    {
+        if (swGroupMatchEmpty(sw->ctrl + g) == 0xFFFF)
+            sw->EmptyGroups++;
+    }
+    for (size_t i = 0; i < sw->M; i++)
+    {
+        if (sw->ctrl[i] >= 0)
+        {
+            char *s = sw->getString(sw->slots[i].data);
+            size_t grupos = 0;
+            swFindSlot(sw, s, htMix(sw->hash(s, (unsigned int)strlen(s))), &grupos);
+            if (grupos > sw->StatsMax)
+                sw->StatsMax = grupos;
+            if (sw->StatsMin == 0 || grupos < sw->StatsMin)
+                sw->StatsMin = grupos;
+        }
+    }
+}
+
+/**
+ * @brief função para inicializar uma tabela com capacidade para (pelo menos) "m" itens sem crescer
+ *
+ * @param m
+ * @param fh
+ * @param dd
+ * @param gs
+ * @return SwissTableCFG*
+ */
+SwissTableCFG *newSwissTable(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs)
+{
+    SwissTableCFG *novo = (SwissTableCFG *)malloc(sizeof(SwissTableCFG));
+    assert(novo);
+    novo->totalItems = 0;
+    novo->nextDataID = 1;
+    novo->StatsMax = novo->StatsMin = novo->EmptyGroups = 0;
+    novo->hash = fh;
+    novo->getString = gs;
+    novo->destroy = dd;
+    novo->lastFound = NULL;
+    swAllocTable(novo, swCapacity(m));
+    return novo;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file swisstable_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface de uma hashtable de endereçamento aberto (estilo "Swiss table") sem o tipo de dados definido.
+ * Oferece as mesmas operações da hashtable com listas ("hashtable_jc.h") para que seja possível trocar de motor
+ * sem reescrever o código que a utiliza.
+ * @version 0.1
+ * @date 2021-05-20
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_SWISSTABLE_JC_H
+#define INC_14AED2HASH_SWISSTABLE_JC_H
+
+#include <stdbool.h>
+#include "hashtable_jc.h"
+#include "hash_known_algorithms.h"
+
+/**
+ * @brief número de posições analisadas de cada vez (um registo SSE2 de bytes de controlo)
+ */
+#define SW_GROUP_WIDTH 16
+
+/**
+ * @brief fator de carga máximo (7/8) a partir do qual a tabela duplica
+ */
+#define SW_MAX_LOAD_NUM 7
+#define SW_MAX_LOAD_DEN 8
+
+/**
+ * @brief valores especiais dos bytes de controlo, os restantes (0..127) guardam 7 bits do hash;
+ * as posições apagadas continuam a fazer parte das sequências de sondagem até ao próximo "swGrow"
+ */
+#define SW_CTRL_EMPTY ((signed char)-128)
+#define SW_CTRL_DELETED ((signed char)-2)
+
+/**
+ * @brief cada posição da tabela guarda o apontador para os dados e o contador de repetições
+ */
+typedef struct swisstableslot SwissTableSlot;
+struct swisstableslot {
+    void *data;                 /**< apontador para os dados do utilizador. */
+    unsigned long long count;   /**< número de vezes que os dados foram inseridos novamente. */
+};
+
+/**
+ * @brief estrutura de configuração da hashtable de endereçamento aberto
+ */
+typedef struct swisstablecfg SwissTableCFG;
+struct swisstablecfg {
+    size_t M;                               /**< número de posições (potência de 2, múltiplo de SW_GROUP_WIDTH). */
+    size_t totalItems;                      /**< total de itens guardados. */
+    size_t growthLeft;                      /**< inserções possíveis até ser necessário crescer. */
+    unsigned long long nextDataID;          /**< próximo ID (igual ao "nextDataID" da hashtable_jc). */
+    size_t StatsMax, StatsMin, EmptyGroups; /**< maior/menor número de grupos visitados por uma chave presente e grupos vazios. */
+    signed char *ctrl;                      /**< bytes de controlo, um por posição. */
+    SwissTableSlot *slots;                  /**< posições com os dados. */
+    SwissTableSlot *lastFound;              /**< posição encontrada na última pesquisa. */
+    TfuncHashKnownAlgorithm hash;           /**< função de hash completa (ver "hash_known_algorithms.h"). */
+    TfuncHashTableGetString getString;      /**< função que devolve a string (chave) dos dados. */
+    TfuncHashTableDestroyData destroy;      /**< procedimento para libertar os dados. */
+};
+
+SwissTableCFG *newSwissTable(size_t m, TfuncHashKnownAlgorithm fh, TfuncHashTableDestroyData dd, TfuncHashTableGetString gs);
+SwissTableCFG *destroySwissTable(SwissTableCFG *sw);
+
+bool swInsertData(SwissTableCFG *sw, void *data);
+bool swExistString(SwissTableCFG *sw, char *v);
+bool swRemoveString(SwissTableCFG *sw, char *v);
+void swStatsCalc(SwissTableCFG *sw);
+
+#endif //INC_14AED2HASH_SWISSTABLE_JC_H
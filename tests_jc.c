@@ -0,0 +1,1306 @@
+/**
+ * @file tests_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief testes de comportamento das estruturas: cada teste verifica os resultados com "assert" e termina o
+ * programa no primeiro que falhar. Compilar e correr (ver README):
+ * gcc -std=gnu11 -O1 -g -o tests_jc tests_jc.c [todos os *_jc.c e hash_known_algorithms.c] -lm -lpthread && ./tests_jc
+ * @version 0.1
+ * @date 2021-06-10
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#undef NDEBUG
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ctype.h>
+#include "hashtable_jc.h"
+#include "hash_known_algorithms.h"
+#include "lib_jc.h"
+#include "swisstable_jc.h"
+#include "robinhood_jc.h"
+#include "mphf_jc.h"
+#include "hashtable_snapshot_jc.h"
+#include "wordcount_jc.h"
+#include "hashtable_mt_jc.h"
+
+// uso interno, não exportar!!!!!
+char *testGetString(void *data)
+{
+    return (char *)data;
+}
+
+// uso interno, não exportar!!!!!
+// função de hash antiga que não usa "M": a posição só é válida enquanto a tabela tiver 7 linhas
+int testHash7(void *data, void *ctx)
+{
+    (void)ctx;
+    char *s = (char *)data;
+    return (int)(DJBHash(s, (unsigned int)strlen(s)) % 7);
+}
+
+// uso interno, não exportar!!!!!
+// função de hash completa em que todas as chaves colidem (uma só sequência de sondagem)
+unsigned int testHashZero(const char *str, unsigned int length)
+{
+    (void)str;
+    (void)length;
+    return 0;
+}
+
+// uso interno, não exportar!!!!!
+// função de hash completa que só lê a chave até ao '-': as chaves "<grupo>-<i>" do mesmo grupo colidem todas
+unsigned int testHashGrupo(const char *str, unsigned int length)
+{
+    const char *fim = memchr(str, '-', length);
+    return DJBHash(str, fim ? (unsigned int)(fim - str) : length);
+}
+
+// uso interno, não exportar!!!!!
+// primalidade por divisão, a referência dos testes dos primos
+bool testTrialPrime(unsigned long long n)
+{
+    if (n < 2)
+        return false;
+    for (unsigned long long d = 2; d * d <= n; d++)
+    {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+
+// uso interno, não exportar!!!!!
+// devolve um array com "n" chaves distintas "<prefixo><i>" (libertar com testFreeKeys)
+char **testKeys(const char *prefixo, int n)
+{
+    char **keys = (char **)malloc((size_t)n * sizeof(char *));
+    assert(keys);
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = (char *)malloc(strlen(prefixo) + 12);
+        assert(keys[i]);
+        sprintf(keys[i], "%s%d", prefixo, i);
+    }
+    return keys;
+}
+
+// uso interno, não exportar!!!!!
+void testFreeKeys(char **keys, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        free(keys[i]);
+    }
+    free(keys);
+}
+
+/**
+ * @brief redimensionamento: as tabelas com função de hash antiga não crescem sem htSetLoadFactor,
+ * as tabelas com função de hash completa crescem e encontram todas as chaves durante e depois do rehash
+ */
+void testResize(void)
+{
+    int n = 5000;
+    char **keys = testKeys("k", n);
+    HashTableCFG *ht = newHashTable(7, testHash7, fakeHashDestroy, testGetString);
+    size_t m = ht->M;
+    for (int i = 0; i < n; i++)
+    {
+        assert(htInsertData(ht, keys[i]));
+    }
+    assert(ht->M == m && !htIsRehashing(ht));
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]));
+    }
+    destroyHashTable(ht);
+
+    // a dimensão pedida na criação é o primo mais próximo, os crescimentos passam ao primo seguinte da tabela
+    ht = newHashTableHashKey(1000, DJBHash, fakeHashDestroy, testGetString);
+    assert(ht->M == 1009);
+    destroyHashTable(ht);
+    ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    assert(ht->M == 7);
+    int crescimentos = 0;
+    for (int i = 0; i < n; i++)
+    {
+        size_t anterior = ht->M;
+        assert(htInsertData(ht, keys[i]));
+        if (ht->M != anterior)
+        {
+            int p = 0;
+            while (hashTablePrimes[p] <= anterior)
+                p++;
+            assert(ht->M == (size_t)hashTablePrimes[p]);
+            crescimentos++;
+        }
+        // as chaves já inseridas são encontradas mesmo a meio de um rehash
+        assert(htExistString(ht, keys[i / 2]));
+    }
+    assert(crescimentos >= 3 && ht->totalItems == (size_t)n);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]));
+        assert(!htInsertData(ht, keys[i]));
+    }
+    assert(!htExistString(ht, "nao-existe"));
+    // as dimensões são primos da tabela "hashTablePrimes" e, ao remover tudo, a tabela volta à dimensão inicial
+    assert(getHashTablePrime(ht->M) == ht->M);
+    htSetLoadFactor(ht, ht->loadFactorMax, ht->loadFactorMax / 4);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htRemoveString(ht, keys[i]));
+        assert(getHashTablePrime(ht->M) == ht->M || ht->M == ht->initialM);
+    }
+    htRehashAll(ht);
+    assert(ht->M == ht->initialM && ht->initialM == 7);
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testResize: ok\n");
+}
+
+/**
+ * @brief tabela "Swiss": inserir, pesquisar e remover (posições apagadas), sem perder chaves que passaram
+ * por posições apagadas e sem crescer com ciclos de inserções/remoções
+ */
+void testSwissTable(void)
+{
+    int n = 20000;
+    char **keys = testKeys("s", n);
+    SwissTableCFG *sw = newSwissTable(16, DJBHash, fakeHashDestroy, testGetString);
+    for (int i = 0; i < n; i++)
+    {
+        assert(swInsertData(sw, keys[i]));
+    }
+    assert(!swInsertData(sw, keys[3]) && sw->lastFound->count == 1);
+    for (int i = 0; i < n; i += 2)
+    {
+        assert(swRemoveString(sw, keys[i]));
+        assert(!swRemoveString(sw, keys[i]));
+    }
+    assert(sw->totalItems == (size_t)n / 2);
+    for (int i = 0; i < n; i++)
+    {
+        assert(swExistString(sw, keys[i]) == (i % 2 == 1));
+    }
+    size_t m = sw->M;
+    for (int r = 0; r < 20; r++)
+    {
+        for (int i = 0; i < n; i += 2)
+        {
+            assert(swInsertData(sw, keys[i]));
+        }
+        for (int i = 0; i < n; i += 2)
+        {
+            assert(swRemoveString(sw, keys[i]));
+        }
+    }
+    assert(sw->M == m);
+    for (int i = 0; i < n; i++)
+    {
+        assert(swExistString(sw, keys[i]) == (i % 2 == 1));
+    }
+    destroySwissTable(sw);
+    testFreeKeys(keys, n);
+    printf("testSwissTable: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// verifica que cada posição ocupada guarda a distância exata à posição ideal e que as sequências não têm
+// buracos (nenhuma posição a seguir a uma vazia está fora da posição ideal)
+void testRobinHoodInvariant(RobinHoodCFG *rh)
+{
+    size_t mask = rh->M - 1;
+    size_t total = 0;
+    for (size_t i = 0; i < rh->M; i++)
+    {
+        RobinHoodSlot *slot = rh->slots + i;
+        if (slot->dist == RH_DIST_EMPTY)
+            continue;
+        total++;
+        // "hash" já está misturado
+        assert(slot->dist == ((i - (slot->hash & mask)) & mask));
+        RobinHoodSlot *anterior = rh->slots + ((i - 1) & mask);
+        assert(slot->dist == 0 || (anterior->dist != RH_DIST_EMPTY && anterior->dist + 1 >= slot->dist));
+    }
+    assert(total == rh->totalItems);
+}
+
+/**
+ * @brief tabela Robin Hood: as remoções recuam as posições seguintes ("backward shift") sem perder chaves,
+ * com hash normal e com todas as chaves na mesma sequência
+ */
+void testRobinHood(void)
+{
+    int n = 3000;
+    char **keys = testKeys("r", n);
+    TfuncHashKnownAlgorithm funcs[] = {DJBHash, testHashZero};
+    for (int f = 0; f < 2; f++)
+    {
+        RobinHoodCFG *rh = newRobinHoodTable(16, funcs[f], fakeHashDestroy, testGetString);
+        for (int i = 0; i < n; i++)
+        {
+            assert(rhInsertData(rh, keys[i]));
+        }
+        assert(!rhInsertData(rh, keys[5]) && rh->lastFound->count == 1);
+        testRobinHoodInvariant(rh);
+        for (int i = 0; i < n; i += 2)
+        {
+            assert(rhRemoveString(rh, keys[i]));
+            assert(!rhRemoveString(rh, keys[i]));
+        }
+        assert(rh->totalItems == (size_t)n / 2);
+        testRobinHoodInvariant(rh);
+        for (int i = 0; i < n; i++)
+        {
+            assert(rhExistString(rh, keys[i]) == (i % 2 == 1));
+        }
+        // remover tudo deixa a tabela vazia
+        for (int i = 1; i < n; i += 2)
+        {
+            assert(rhRemoveString(rh, keys[i]));
+        }
+        rhStatsCalc(rh);
+        assert(rh->totalItems == 0 && rh->EmptyRow == rh->M);
+        destroyRobinHoodTable(rh);
+    }
+    testFreeKeys(keys, n);
+    printf("testRobinHood: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// verifica que "mph" dá a cada uma das "n" chaves um índice distinto em [0, n)
+void testMphfBijection(MphfCFG *mph, char **keys, int n)
+{
+    assert(mph && mph->n == (unsigned long long)n);
+    bool *usado = (bool *)calloc((size_t)n, sizeof(bool));
+    assert(usado);
+    for (int i = 0; i < n; i++)
+    {
+        unsigned long long idx = mphfLookupString(mph, keys[i]);
+        assert(idx < (unsigned long long)n && !usado[idx]);
+        usado[idx] = true;
+    }
+    free(usado);
+}
+
+/**
+ * @brief função de hash perfeita mínima: é uma bijeção entre as chaves e [0, n), construída a partir das strings,
+ * de uma hashtable (a meio de um rehash e com chaves no nodo) e depois de gravar e ler o ficheiro
+ */
+void testMphf(void)
+{
+    int n = 50000;
+    char **keys = testKeys("m", n);
+    MphfCFG *mph = newMphfStrings(keys, (size_t)n);
+    testMphfBijection(mph, keys, n);
+
+    const char *path = "tests_jc_mphf.bin";
+    assert(mphfSave(mph, path));
+    MphfCFG *lido = mphfLoad(path);
+    remove(path);
+    testMphfBijection(lido, keys, n);
+    for (int i = 0; i < n; i++)
+    {
+        assert(mphfLookupString(lido, keys[i]) == mphfLookupString(mph, keys[i]));
+    }
+    destroyMphf(lido);
+    destroyMphf(mph);
+
+    for (int inl = 0; inl <= 1; inl++)
+    {
+        HashTableCFG *ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+        if (inl)
+            htSetInlineKeys(ht);
+        for (int i = 0; i < n; i++)
+        {
+            htInsertData(ht, keys[i]);
+        }
+        // baixar o fator de carga alvo inicia um rehash: as chaves ficam todas nas linhas da tabela antiga
+        htSetLoadFactor(ht, ht->loadFactor / 2, 0);
+        assert(htIsRehashing(ht));
+        mph = newMphfFromHashTable(ht);
+        testMphfBijection(mph, keys, n);
+        destroyMphf(mph);
+        destroyHashTable(ht);
+    }
+
+    // as chaves repetidas não têm função perfeita
+    char *repetidas[] = {"a", "b", "a"};
+    assert(newMphfStrings(repetidas, 3) == NULL);
+    testFreeKeys(keys, n);
+    printf("testMphf: ok\n");
+}
+
+/**
+ * @brief "snapshot": o ficheiro tem exatamente as chaves e contadores da tabela, e um ficheiro corrompido
+ * (deslocamentos e comprimentos inválidos) é rejeitado ou pesquisado sem ler fora do ficheiro
+ */
+void testSnapshot(void)
+{
+    int n = 20000;
+    char **keys = testKeys("p", n);
+    const char *path = "tests_jc_snapshot.bin";
+    HashTableCFG *ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    for (int i = 0; i < n; i++)
+    {
+        htInsertData(ht, keys[i]);
+        if (i % 3 == 0)
+            htInsertData(ht, keys[i]);
+    }
+    assert(htSaveSnapshot(ht, path));
+    HashTableSnapshot *snap = htOpenSnapshot(path, DJBHash);
+    assert(snap && snap->header->totalItems == (unsigned long long)n && snap->header->M == ht->M);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htSnapshotExistString(snap, keys[i]));
+        assert(snap->lastFound->count == (i % 3 == 0 ? 1ULL : 0ULL));
+        assert(strcmp(snap->lastFound->key, keys[i]) == 0);
+    }
+    assert(!htSnapshotExistString(snap, "nao-existe"));
+    // todas as chaves do ficheiro estão na tabela, e são tantas quantas as da tabela
+    size_t total = 0;
+    for (size_t i = 0; i < snap->header->M; i++)
+    {
+        for (unsigned long long off = snap->buckets[i]; off; off = ((const HashTableSnapshotEntry *)(snap->base + off))->next)
+        {
+            const HashTableSnapshotEntry *entry = (const HashTableSnapshotEntry *)(snap->base + off);
+            assert(htExistString(ht, (char *)entry->key) && entry->length == strlen(entry->key));
+            total++;
+        }
+    }
+    assert(total == (size_t)n);
+    htCloseSnapshot(snap);
+    assert(!htOpenSnapshot(path, JSHash));
+
+    // corromper: linhas para fora do ficheiro ou desalinhadas, comprimentos e próximos inválidos
+    FILE *f = fopen(path, "r+b");
+    assert(f);
+    HashTableSnapshotHeader header;
+    assert(fread(&header, sizeof(header), 1, f) == 1);
+    unsigned long long *buckets = (unsigned long long *)malloc(header.M * sizeof(unsigned long long));
+    assert(buckets && fread(buckets, sizeof(unsigned long long), header.M, f) == header.M);
+    for (size_t i = 0; i < header.M; i++)
+    {
+        if (!buckets[i])
+            continue;
+        HashTableSnapshotEntry entry;
+        assert(fseek(f, (long)buckets[i], SEEK_SET) == 0 && fread(&entry, sizeof(entry), 1, f) == 1);
+        switch (i % 5)
+        {
+        case 0: buckets[i] = header.fileSize + 4096; break;
+        case 1: buckets[i] += 3; break;
+        case 2: buckets[i] = 8; break;
+        case 3: entry.length = 0xFFFFFFF0U; break;
+        default: entry.next = entry.next ? header.fileSize - 8 : buckets[i]; break;
+        }
+        assert(fseek(f, (long)(i % 5 == 3 || i % 5 == 4 ? buckets[i] : 0), SEEK_SET) == 0);
+        if (i % 5 >= 3)
+            assert(fwrite(&entry, sizeof(entry), 1, f) == 1);
+    }
+    assert(fseek(f, (long)header.buckets, SEEK_SET) == 0 && fwrite(buckets, sizeof(unsigned long long), header.M, f) == header.M);
+    assert(fclose(f) == 0);
+    free(buckets);
+    snap = htOpenSnapshot(path, DJBHash);
+    assert(snap);
+    int encontradas = 0;
+    for (int i = 0; i < n; i++)
+    {
+        encontradas += htSnapshotExistString(snap, keys[i]) ? 1 : 0;
+    }
+    assert(encontradas < n);
+    htCloseSnapshot(snap);
+    // um cabeçalho com o array de linhas fora do ficheiro é rejeitado
+    f = fopen(path, "r+b");
+    assert(f);
+    header.buckets = header.fileSize;
+    assert(fwrite(&header, sizeof(header), 1, f) == 1 && fclose(f) == 0);
+    assert(!htOpenSnapshot(path, DJBHash));
+    remove(path);
+
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testSnapshot: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// compara as estatísticas mantidas operação a operação com as linhas percorridas (as duas tabelas durante um rehash)
+void testStatsCheck(HashTableCFG *ht)
+{
+    size_t *histograma = (size_t *)calloc(ht->totalItems + 1, sizeof(size_t));
+    assert(histograma);
+    size_t maior = 0, menor = (size_t)-1, total = 0;
+    unsigned long long colisoesMax = 0, colisoesMin = (unsigned long long)-1;
+    for (int t = 0; t < 2; t++)
+    {
+        NodoHashTable **rows = t == 0 ? ht->hashtable : ht->oldHashtable;
+        HashTableRowStats *stats = t == 0 ? ht->rowStats : ht->oldRowStats;
+        // as linhas antigas já migradas deixaram de contar
+        for (size_t i = t == 0 ? 0 : ht->rehashPos; rows && i < (t == 0 ? ht->M : ht->oldM); i++)
+        {
+            size_t l = 0;
+            unsigned long long c = 0;
+            for (NodoHashTable *nodo = rows[i]; nodo; nodo = nodo->next)
+            {
+                l++;
+                c += nodo->count;
+            }
+            assert(stats[i].length == l && stats[i].count == c);
+            histograma[l]++;
+            maior = l > maior ? l : maior;
+            menor = l < menor ? l : menor;
+            colisoesMax = c > colisoesMax ? c : colisoesMax;
+            colisoesMin = c < colisoesMin ? c : colisoesMin;
+            total += l;
+        }
+    }
+    assert(total == ht->totalItems);
+    assert(ht->StatsMax == maior && ht->StatsMin == menor && ht->EmptyRow == histograma[0]);
+    HashTableStats stats;
+    htStatsRead(ht, &stats);
+    assert(stats.StatsMax == maior && stats.StatsMin == menor && stats.EmptyRow == histograma[0]);
+    assert(stats.ColisionsMax == colisoesMax && stats.ColisionsMin == colisoesMin);
+    for (size_t l = 0; l <= maior; l++)
+    {
+        assert(ht->chainHistogram[l] == histograma[l]);
+    }
+    free(histograma);
+}
+
+/**
+ * @brief estatísticas mantidas em cada operação: o comprimento e a soma dos contadores de cada linha, o histograma
+ * e os limites coincidem com os das listas depois de inserções, repetições e remoções, a meio e fora de rehashes
+ */
+void testStatsTracking(void)
+{
+    int n = 6000;
+    char **keys = testKeys("e", n);
+    HashTableCFG *ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    htSetStatsTracking(ht, true);
+    bool rehash = false;
+    for (int i = 0; i < n; i++)
+    {
+        htInsertData(ht, keys[i]);
+        if (i % 4 == 0)
+            htInsertData(ht, keys[i / 2]);
+        if (i % 97 == 0)
+            testStatsCheck(ht);
+        rehash = rehash || htIsRehashing(ht);
+    }
+    assert(rehash);
+    testStatsCheck(ht);
+    // remover quase tudo faz a tabela encolher
+    for (int i = 0; i < n - 10; i++)
+    {
+        assert(htRemoveString(ht, keys[i]));
+        if (i % 97 == 0)
+            testStatsCheck(ht);
+    }
+    testStatsCheck(ht);
+    htStatsCalc(ht);
+    testStatsCheck(ht);
+
+    // inserções, repetições e remoções ao acaso: os limites dos contadores também descem
+    srand(4321);
+    for (int i = 0; i < 60000; i++)
+    {
+        char *k = keys[rand() % 2000];
+        if (rand() % 3 == 0)
+            htRemoveString(ht, k);
+        else
+            htInsertData(ht, k);
+        if (i % 499 == 0)
+            testStatsCheck(ht);
+    }
+    testStatsCheck(ht);
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testStatsTracking: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// o contador de linhas com árvore coincide com as árvores das duas tabelas
+void testTreeCount(HashTableCFG *ht)
+{
+    size_t n = 0;
+    for (size_t i = 0; ht->trees && i < ht->M; i++)
+    {
+        n += ht->trees[i] ? 1 : 0;
+    }
+    for (size_t i = ht->rehashPos; ht->oldTrees && i < ht->oldM; i++)
+    {
+        n += ht->oldTrees[i] ? 1 : 0;
+    }
+    assert(ht->TreeifiedRows == n);
+}
+
+/**
+ * @brief árvores durante o rehash: com grupos de chaves que colidem todas, as linhas da tabela antiga ainda
+ * por migrar continuam a ser pesquisadas na sua árvore, cada pesquisa a meio do rehash visita poucos nodos
+ * (uma lista do grupo teria em média metade das chaves); as remoções a meio do rehash mantêm as árvores
+ */
+void testTreeRehash(void)
+{
+    int grupos = 256, porGrupo = 100, n = grupos * porGrupo;
+    char **keys = (char **)malloc((size_t)n * sizeof(char *));
+    assert(keys);
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = (char *)malloc(24);
+        assert(keys[i]);
+        // chaves seguidas são de grupos diferentes
+        sprintf(keys[i], "g%d-%d", i % grupos, i / grupos);
+    }
+    HashTableCFG *ht = newHashTableHashKey(7, testHashGrupo, fakeHashDestroy, testGetString);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htInsertData(ht, keys[i]));
+    }
+    htRehashAll(ht);
+    assert(ht->TreeifiedRows >= (size_t)grupos / 2);
+    testTreeCount(ht);
+
+    htSetStatsTracking(ht, true);
+    htSetLoadFactor(ht, ht->loadFactor / 2, 0);
+    assert(htIsRehashing(ht) && ht->oldTrees);
+    testTreeCount(ht);
+    int aMeio = 0;
+    for (int i = 0; i < n; i++)
+    {
+        bool rehash = htIsRehashing(ht);
+        unsigned long long probes = ht->probesHit;
+        assert(htExistString(ht, keys[i]));
+        if (rehash)
+        {
+            aMeio++;
+            // uma árvore com 100 nodos tem no máximo 9 níveis, na tabela atual e na antiga
+            assert(ht->probesHit - probes <= 2 * 10);
+        }
+    }
+    assert(aMeio >= grupos / HT_REHASH_STEP / 2);
+    testTreeCount(ht);
+
+    // remover tudo a meio de um novo rehash desfaz as árvores das duas tabelas
+    assert(!htIsRehashing(ht));
+    htSetLoadFactor(ht, ht->loadFactor / 2, 0);
+    assert(htIsRehashing(ht) && ht->oldTrees);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htRemoveString(ht, keys[i]));
+        if (i % 101 == 0)
+            testTreeCount(ht);
+    }
+    htRehashAll(ht);
+    assert(ht->totalItems == 0 && ht->TreeifiedRows == 0);
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testTreeRehash: ok\n");
+}
+
+/**
+ * @brief carga em paralelo: com chaves repetidas (cópias em memória diferente, espalhadas pelos blocos das
+ * threads), chaves que já estavam na tabela e grupos de chaves que colidem (árvores criadas pelas threads),
+ * o resultado é igual ao da carga em série: os mesmos itens inseridos, os mesmos dados (a primeira ocorrência)
+ * e os mesmos contadores em cada chave
+ */
+void testParallelBuild(void)
+{
+    int threads = 4, distintas = 20000;
+    size_t n = (size_t)threads * HT_PARALLEL_MIN_ITEMS * 2;
+    char **a = (char **)malloc((size_t)distintas * sizeof(char *));
+    char **b = (char **)malloc((size_t)distintas * sizeof(char *));
+    void **data = (void **)malloc(n * sizeof(void *));
+    bool *emSerie = (bool *)malloc(n * sizeof(bool));
+    bool *emParalelo = (bool *)malloc(n * sizeof(bool));
+    assert(a && b && data && emSerie && emParalelo);
+    for (int i = 0; i < distintas; i++)
+    {
+        a[i] = (char *)malloc(24);
+        b[i] = (char *)malloc(24);
+        assert(a[i] && b[i]);
+        sprintf(a[i], "g%d-%d", i % 500, i);
+        strcpy(b[i], a[i]);
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        int k = (int)((i * 7919) % (size_t)distintas);
+        data[i] = i % 3 == 0 ? b[k] : a[k];
+    }
+
+    HashTableCFG *serie = newHashTableHashKey(7, testHashGrupo, fakeHashDestroy, testGetString);
+    HashTableCFG *paralelo = newHashTableHashKey(7, testHashGrupo, fakeHashDestroy, testGetString);
+    // algumas chaves já existem antes da carga
+    for (int i = 0; i < distintas; i += 10)
+    {
+        assert(htInsertData(serie, a[i]) && htInsertData(paralelo, a[i]));
+    }
+    size_t novos = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        emSerie[i] = htInsertData(serie, data[i]);
+        novos += emSerie[i] ? 1 : 0;
+    }
+    assert(htInsertDataParallel(paralelo, data, n, threads, emParalelo) == novos);
+    assert(paralelo->totalItems == serie->totalItems && paralelo->nextDataID == serie->nextDataID);
+    for (size_t i = 0; i < n; i++)
+    {
+        assert(emParalelo[i] == emSerie[i]);
+    }
+    for (int i = 0; i < distintas; i++)
+    {
+        assert(htExistString(serie, a[i]) && htExistString(paralelo, a[i]));
+        assert(paralelo->lastFound->data == serie->lastFound->data);
+        assert(paralelo->lastFound->count == serie->lastFound->count);
+    }
+    assert(!htExistString(paralelo, "g1-nao-existe"));
+    assert(paralelo->TreeifiedRows > 0);
+    testTreeCount(paralelo);
+
+    destroyHashTable(serie);
+    destroyHashTable(paralelo);
+    testFreeKeys(a, distintas);
+    testFreeKeys(b, distintas);
+    free(data);
+    free(emSerie);
+    free(emParalelo);
+    printf("testParallelBuild: ok\n");
+}
+
+/**
+ * @brief pesquisas e inserções em lote: com chaves repetidas dentro do mesmo lote e rehashes a meio, "inserted"
+ * e os contadores coincidem com htInsertData item a item, e cada resultado das pesquisas em lote é o mesmo
+ * de htExistString (os dados da chave ou NULL)
+ */
+void testBatch(void)
+{
+    int distintas = 3000, n = 5000;
+    char **keys = testKeys("b", distintas);
+    void **data = (void **)malloc((size_t)n * sizeof(void *));
+    bool *emSerie = (bool *)malloc((size_t)n * sizeof(bool));
+    bool *emLote = (bool *)malloc((size_t)n * sizeof(bool));
+    assert(data && emSerie && emLote);
+    for (int i = 0; i < n; i++)
+    {
+        // em cada 4 itens o último repete o anterior (no mesmo lote); a partir de "distintas" repetem-se todas
+        data[i] = keys[i % 4 == 3 ? (i - 1) % distintas : i % distintas];
+    }
+    HashTableCFG *serie = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    HashTableCFG *lote = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    size_t novos = 0;
+    for (int i = 0; i < n; i++)
+    {
+        emSerie[i] = htInsertData(serie, data[i]);
+        novos += emSerie[i] ? 1 : 0;
+    }
+    bool rehash = false;
+    for (int base = 0; base < n; base += 100)
+    {
+        int k = n - base < 100 ? n - base : 100;
+        assert(htInsertDataBatch(lote, data + base, (size_t)k, emLote + base) <= (size_t)k);
+        rehash = rehash || htIsRehashing(lote);
+    }
+    assert(rehash && lote->totalItems == novos && serie->totalItems == novos);
+    for (int i = 0; i < n; i++)
+    {
+        assert(emLote[i] == emSerie[i]);
+    }
+
+    // metade das chaves procuradas não existe
+    int m = 2 * distintas;
+    char **procurar = (char **)malloc((size_t)m * sizeof(char *));
+    char **outras = testKeys("nao", distintas);
+    const void **ptrs = (const void **)malloc((size_t)m * sizeof(void *));
+    unsigned int *lengths = (unsigned int *)malloc((size_t)m * sizeof(unsigned int));
+    void **resultados = (void **)malloc((size_t)m * sizeof(void *));
+    void **resultadosString = (void **)malloc((size_t)m * sizeof(void *));
+    assert(procurar && ptrs && lengths && resultados && resultadosString);
+    size_t existem = 0;
+    for (int i = 0; i < m; i++)
+    {
+        procurar[i] = i % 2 ? outras[i / 2] : keys[i / 2];
+        ptrs[i] = procurar[i];
+        lengths[i] = (unsigned int)strlen(procurar[i]);
+        existem += htExistString(serie, procurar[i]) ? 1 : 0;
+    }
+    htSetLoadFactor(lote, lote->loadFactor / 2, 0);
+    assert(htIsRehashing(lote));
+    assert(htExistKeyBatch(lote, ptrs, lengths, (size_t)m, resultados) == existem);
+    assert(htExistStringBatch(lote, procurar, (size_t)m, resultadosString) == existem);
+    for (int i = 0; i < m; i++)
+    {
+        bool existe = htExistString(serie, procurar[i]);
+        assert(resultados[i] == (existe ? serie->lastFound->data : NULL));
+        assert(resultadosString[i] == resultados[i]);
+        if (existe)
+        {
+            assert(htExistString(lote, procurar[i]) && lote->lastFound->count == serie->lastFound->count);
+        }
+    }
+
+    destroyHashTable(serie);
+    destroyHashTable(lote);
+    testFreeKeys(keys, distintas);
+    testFreeKeys(outras, distintas);
+    free(procurar);
+    free(ptrs);
+    free(lengths);
+    free(resultados);
+    free(resultadosString);
+    free(data);
+    free(emSerie);
+    free(emLote);
+    printf("testBatch: ok\n");
+}
+
+/**
+ * @brief filtro de Bloom: nenhuma chave presente é dada como inexistente (antes e depois de o filtro ser refeito
+ * com o dobro da capacidade e a meio de rehashes), cada pesquisa de uma chave inexistente conta em "BloomSaved"
+ * ou em "BloomFalsePositives", e os falsos positivos ficam perto da taxa pedida
+ */
+void testBloom(void)
+{
+    int n = 4000, pedidas = 20000;
+    char **keys = testKeys("f", n);
+    char **outras = testKeys("x", pedidas);
+    HashTableCFG *ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    for (int i = 0; i < n / 4; i++)
+    {
+        assert(htInsertData(ht, keys[i]));
+    }
+    // as chaves que já existem entram no filtro; a capacidade é pequena para obrigar a refazê-lo
+    htSetBloomFilter(ht, (size_t)n / 4, 0.01);
+    size_t capacidade = ht->bloom->capacity;
+    for (int i = n / 4; i < n; i++)
+    {
+        assert(htInsertData(ht, keys[i]));
+        assert(htExistString(ht, keys[i / 2]));
+    }
+    assert(ht->bloom->capacity > capacidade);
+    // as inserções também pesquisam a chave nova, as pesquisas de chaves presentes não mexem nos contadores
+    unsigned long long poupadas = ht->BloomSaved, falsos = ht->BloomFalsePositives;
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]));
+    }
+    assert(ht->BloomSaved == poupadas && ht->BloomFalsePositives == falsos);
+
+    for (int i = 0; i < pedidas; i++)
+    {
+        assert(!htExistString(ht, outras[i]));
+    }
+    poupadas = ht->BloomSaved - poupadas;
+    falsos = ht->BloomFalsePositives - falsos;
+    assert(poupadas + falsos == (unsigned long long)pedidas);
+    assert(falsos <= (unsigned long long)pedidas * 3 / 100);
+
+    // as remoções não limpam o filtro, mas as chaves removidas deixam de ser encontradas
+    for (int i = 0; i < n; i += 2)
+    {
+        assert(htRemoveString(ht, keys[i]));
+    }
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]) == (i % 2 == 1));
+    }
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    testFreeKeys(outras, pedidas);
+    printf("testBloom: ok\n");
+}
+
+/**
+ * @brief "top-k": a chave "i" é repetida "i" vezes, os "k" nodos devolvidos são as "k" chaves mais repetidas por ordem
+ * decrescente de "count" (também a meio de um rehash); com "k" maior do que o número de itens são devolvidos todos
+ */
+void testTopK(void)
+{
+    int n = 300;
+    char **keys = testKeys("t", n);
+    HashTableCFG *ht = newHashTableHashKey(7, DJBHash, fakeHashDestroy, testGetString);
+    for (int i = 0; i < n; i++)
+    {
+        for (int r = 0; r <= i; r++)
+        {
+            htInsertData(ht, keys[i]);
+        }
+    }
+    NodoHashTable **out = (NodoHashTable **)malloc((size_t)(n + 10) * sizeof(NodoHashTable *));
+    assert(out);
+    htSetLoadFactor(ht, ht->loadFactor / 2, 0);
+    assert(htIsRehashing(ht));
+    assert(htTopK(ht, 0, out) == 0);
+    assert(htTopK(ht, 10, out) == 10);
+    for (int j = 0; j < 10; j++)
+    {
+        assert(out[j]->count == (unsigned long long)(n - 1 - j) && out[j]->data == keys[n - 1 - j]);
+    }
+    assert(htTopK(ht, (size_t)n + 10, out) == (size_t)n);
+    for (int j = 0; j < n; j++)
+    {
+        assert(out[j]->count == (unsigned long long)(n - 1 - j));
+    }
+    free(out);
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testTopK: ok\n");
+}
+
+/**
+ * @brief dimensionamento com potências de 2 (máscara e redução de Lemire): M é sempre potência de 2, todas as chaves
+ * são encontradas durante e depois dos rehashes de crescimento e de encolhimento, e a linha está sempre dentro da tabela
+ */
+void testSizing(void)
+{
+    int n = 5000;
+    char **keys = testKeys("s", n);
+    const HashTableSizing modos[] = {HT_SIZING_POW2_MASK, HT_SIZING_POW2_FASTRANGE};
+    for (int m = 0; m < 2; m++)
+    {
+        HashTableCFG *ht = newHashTableHashKey(100, DJBHash, fakeHashDestroy, testGetString);
+        htSetSizing(ht, modos[m]);
+        assert(ht->M == 128 && ht->initialM == 128);
+        htSetLoadFactor(ht, ht->loadFactorMax, ht->loadFactorMax / 4);
+        bool rehash = false;
+        for (int i = 0; i < n; i++)
+        {
+            assert(htInsertData(ht, keys[i]));
+            assert(htExistString(ht, keys[i / 2]));
+            assert((ht->M & (ht->M - 1)) == 0);
+            rehash = rehash || htIsRehashing(ht);
+        }
+        assert(rehash && ht->M >= (size_t)n / 2);
+        for (int i = 0; i < n; i++)
+        {
+            assert(htExistString(ht, keys[i]));
+        }
+        for (unsigned int h = 0; h < 100000; h += 7)
+        {
+            assert(htSizingBucket(modos[m], h * 2654435761U, ht->M) < ht->M);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            assert(htRemoveString(ht, keys[i]));
+            assert(!htExistString(ht, keys[i]));
+            if (i + 1 < n)
+                assert(htExistString(ht, keys[n - 1]));
+            assert((ht->M & (ht->M - 1)) == 0);
+        }
+        htRehashAll(ht);
+        assert(ht->M == 128 && ht->totalItems == 0);
+        destroyHashTable(ht);
+    }
+    testFreeKeys(keys, n);
+    printf("testSizing: ok\n");
+}
+
+/**
+ * @brief primos: isPrimeNumber64 coincide com a divisão até 200000 e em números ao acaso de 36 bits, acerta nos
+ * pseudoprimos fortes e nos limites de 64 bits; primeSieveRange devolve os mesmos primos por ordem crescente
+ * (também no caminho sem crivo, com sqrt(hi) maior do que o intervalo) e conta para lá de "max"
+ */
+void testPrimes(void)
+{
+    for (unsigned long long n = 0; n < 200000; n++)
+    {
+        assert(isPrimeNumber64(n) == testTrialPrime(n));
+    }
+    unsigned long long x = 88172645463325252ULL;
+    for (int i = 0; i < 300; i++)
+    {
+        // xorshift64
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        unsigned long long n = x >> 28;
+        assert(isPrimeNumber64(n) == testTrialPrime(n));
+    }
+    // pseudoprimos fortes nas bases pequenas, número de Carmichael e limites de 64 bits
+    assert(!isPrimeNumber64(3215031751ULL) && !isPrimeNumber64(3825123056546413051ULL) && !isPrimeNumber64(561));
+    assert(isPrimeNumber64(18446744073709551557ULL) && !isPrimeNumber64(18446744073709551615ULL));
+    assert(getNearestPrimeNumber64(18446744073709551556ULL) == 18446744073709551557ULL);
+    for (int i = 0; i < hashTablePrimesCount; i++)
+    {
+        assert(isPrimeNumber64(hashTablePrimes[i]) && getHashTablePrime(hashTablePrimes[i]) == hashTablePrimes[i]);
+        assert(i == 0 || getHashTablePrime(hashTablePrimes[i - 1] + 1) == hashTablePrimes[i]);
+    }
+
+    const unsigned long long intervalos[][2] = {{0, 100000}, {99990, 140000}, {1000000000000ULL, 1000000020000ULL},
+                                                {1000000000000000ULL, 1000000000002000ULL}};
+    unsigned long long *out = (unsigned long long *)malloc(20000 * sizeof(unsigned long long));
+    assert(out);
+    for (int t = 0; t < 4; t++)
+    {
+        unsigned long long lo = intervalos[t][0], hi = intervalos[t][1];
+        unsigned long long total = primeSieveRange(lo, hi, out, 20000);
+        unsigned long long j = 0;
+        for (unsigned long long n = lo; n < hi; n++)
+        {
+            bool primo = t < 2 ? testTrialPrime(n) : isPrimeNumber64(n);
+            if (primo)
+                assert(j < total && out[j++] == n);
+        }
+        assert(j == total);
+        // com "max" menor são escritos só os primeiros, mas o total é o mesmo
+        assert(total < 3 || (primeSieveRange(lo, hi, out, 2) == total && out[1] > out[0]));
+    }
+    assert(primeSieveRange(0, 100000, NULL, 0) == 9592);
+    free(out);
+    printf("testPrimes: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// cada nodo tem o hash da função atual e está na linha que esse hash lhe dá
+void testRowsRehashed(HashTableCFG *ht)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < ht->M; i++)
+    {
+        for (NodoHashTable *nodo = ht->hashtable[i]; nodo; nodo = nodo->next)
+        {
+            char *k = (char *)nodo->data;
+            assert(nodo->hash == ht->hashKey(k, (unsigned int)strlen(k)));
+            assert(htSizingBucket(ht->sizing, nodo->hash, ht->M) == i);
+            total++;
+        }
+    }
+    assert(total == ht->totalItems);
+}
+
+/**
+ * @brief escolha da função de hash: a partir de uma função que põe todas as chaves na mesma linha, a escolha
+ * automática troca-a ao fim da amostra por uma bem distribuída e redistribui os itens já inseridos; htSelectHashKey
+ * escolhe a mais rápida entre as funções com variância até HT_AUTOHASH_SLACK acima da melhor (e de 1)
+ */
+void testAutoHash(void)
+{
+    int n = 3000, amostra = 256;
+    char **keys = testKeys("a", n);
+    HashTableCFG *ht = newHashTableHashKey(7, testHashZero, fakeHashDestroy, testGetString);
+    htSetAutoHash(ht, (size_t)amostra);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htInsertData(ht, keys[i]));
+        assert((ht->hashKey == testHashZero) == (i + 1 < amostra));
+    }
+    int f = ht->hashChoice.algorithm;
+    assert(f >= 0 && f < hashKnownAlgorithmsCount && ht->hashKey == hashKnownAlgorithms[f].func);
+    assert(ht->hashChoice.sampleSize == (size_t)amostra && ht->hashChoice.varianceRatio < 2);
+    htRehashAll(ht);
+    testRowsRehashed(ht);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]));
+    }
+
+    const void **ptrs = (const void **)malloc((size_t)n * sizeof(void *));
+    unsigned int *lengths = (unsigned int *)malloc((size_t)n * sizeof(unsigned int));
+    HashTableHashReport *r = (HashTableHashReport *)malloc((size_t)hashKnownAlgorithmsCount * sizeof(HashTableHashReport));
+    assert(ptrs && lengths && r);
+    for (int i = 0; i < n; i++)
+    {
+        ptrs[i] = keys[i];
+        lengths[i] = (unsigned int)strlen(keys[i]);
+    }
+    assert(htSelectHashKey(ht, ptrs, lengths, 1, NULL) == -1);
+    f = htSelectHashKey(ht, ptrs, lengths, (size_t)n, r);
+    assert(f >= 0 && ht->hashKey == hashKnownAlgorithms[f].func && ht->hashChoice.algorithm == f);
+    double melhor = r[0].varianceRatio;
+    for (int g = 0; g < hashKnownAlgorithmsCount; g++)
+    {
+        assert(r[g].algorithm == g && r[g].sampleSize == (size_t)n);
+        melhor = r[g].varianceRatio < melhor ? r[g].varianceRatio : melhor;
+    }
+    double limite = (1 + HT_AUTOHASH_SLACK) * (melhor > 1 ? melhor : 1);
+    assert(r[f].varianceRatio <= limite);
+    for (int g = 0; g < hashKnownAlgorithmsCount; g++)
+    {
+        assert(r[g].varianceRatio > limite || r[g].nsPerKey >= r[f].nsPerKey);
+    }
+    testRowsRehashed(ht);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, keys[i]));
+    }
+    free(ptrs);
+    free(lengths);
+    free(r);
+    destroyHashTable(ht);
+    testFreeKeys(keys, n);
+    printf("testAutoHash: ok\n");
+}
+
+// uso interno, não exportar!!!!!
+// referência da classificação dos bytes das palavras
+bool testWordByte(unsigned char c)
+{
+    return isalnum(c) || c >= 0x80;
+}
+
+/**
+ * @brief contagem de palavras: separadores, algarismos, bytes UTF-8 dentro das palavras, maiúsculas distintas,
+ * palavras e espaços maiores que WC_BLOCK e palavra no fim do bloco; os totais de wcIngestBuffer somam-se aos
+ * anteriores e as palavras de wcNextToken batem certo com uma separação byte a byte
+ */
+void testWordCount(void)
+{
+    const char *texto = "                    Ol\xc3\xa1 ol\xc3\xa1, mundo!! 123 abc-abc_ABC caf\xc3\xa9\tcaf\xc3\xa9\n"
+                        "Ol\xc3\xa1 uma-palavra-muito-comprida-que-passa-os-16-bytes "
+                        "abcdefghijklmnopqrstuvwxyz0123456789 123";
+    const char *palavras[] = {"Ol\xc3\xa1", "ol\xc3\xa1", "mundo", "123", "abc", "ABC", "caf\xc3\xa9", "uma", "palavra",
+                              "muito", "comprida", "que", "passa", "os", "16", "bytes",
+                              "abcdefghijklmnopqrstuvwxyz0123456789"};
+    int ocorrencias[] = {2, 1, 1, 2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    int n = (int)(sizeof(palavras) / sizeof(palavras[0]));
+    size_t size = strlen(texto);
+
+    HashTableCFG *ht = newWordCountTable(29);
+    WordCountStats stats;
+    memset(&stats, 0, sizeof(WordCountStats));
+    wcIngestBuffer(ht, texto, size, &stats);
+    assert(stats.tokens == 21 && stats.newTokens == (unsigned long long)n && stats.bytes == size);
+    assert(ht->totalItems == (size_t)n);
+    wcIngestBuffer(ht, texto, size, &stats);
+    assert(stats.tokens == 42 && stats.newTokens == (unsigned long long)n && stats.bytes == 2 * size);
+    assert(ht->totalItems == (size_t)n);
+    for (int i = 0; i < n; i++)
+    {
+        assert(htExistString(ht, (char *)palavras[i]));
+        assert(ht->lastFound->count + 1 == (size_t)(2 * ocorrencias[i]));
+    }
+    assert(!htExistString(ht, "Abc") && !htExistString(ht, "caf") && !htExistString(ht, "abc-abc"));
+
+    // só os primeiros bytes: "Ol" cortado antes do byte UTF-8
+    wcIngestBuffer(ht, texto, 22, &stats);
+    assert(stats.tokens == 43 && stats.newTokens == (unsigned long long)n + 1 && htExistString(ht, "Ol"));
+    destroyHashTable(ht);
+
+    // bloco aleatório: wcNextToken contra uma separação byte a byte
+    const char alfabeto[] = "aZ9 ,-_\n\xc3\xa9";
+    size_t m = 5000;
+    char *buf = (char *)malloc(m);
+    assert(buf);
+    srand(11);
+    for (size_t i = 0; i < m; i++)
+        buf[i] = alfabeto[rand() % (int)(sizeof(alfabeto) - 1)];
+    const char *p = buf, *end = buf + m;
+    size_t length, i = 0;
+    while ((p = wcNextToken(p, end, &length)) != NULL)
+    {
+        while (i < m && !testWordByte((unsigned char)buf[i]))
+            i++;
+        assert(p == buf + i && length > 0);
+        while (i < m && testWordByte((unsigned char)buf[i]))
+            i++;
+        assert(p + length == buf + i);
+        p += length;
+    }
+    while (i < m)
+        assert(!testWordByte((unsigned char)buf[i++]));
+    free(buf);
+    printf("testWordCount: ok\n");
+}
+
+/**
+ * @brief argumentos de cada thread de testHashTableMT
+ */
+typedef struct testmtarg TestMTArg;
+struct testmtarg {
+    HashTableMTCFG *ht;     /**< tabela partilhada. */
+    char **shared;          /**< chaves usadas por todas as threads. */
+    int nShared;            /**< total de chaves partilhadas. */
+    char **own;             /**< chaves só desta thread. */
+    int nOwn;               /**< total de chaves desta thread. */
+    bool *ownPresent;       /**< estado esperado de cada chave desta thread no fim. */
+    unsigned int seed;      /**< semente de rand_r. */
+};
+
+// uso interno, não exportar!!!!!
+// mistura de inserções, remoções e pesquisas sobre as chaves partilhadas e as próprias
+void *testMTWorker(void *v)
+{
+    TestMTArg *a = (TestMTArg *)v;
+    for (int r = 0; r < 20000; r++)
+    {
+        unsigned int x = (unsigned int)rand_r(&a->seed);
+        char *k = a->shared[x % (unsigned int)a->nShared];
+        switch ((x >> 16) % 3)
+        {
+        case 0:
+            htmtInsertData(a->ht, k);
+            break;
+        case 1:
+            htmtRemoveString(a->ht, k);
+            break;
+        default:
+            htmtExistString(a->ht, k);
+        }
+        // as chaves próprias só são alteradas por esta thread, o resultado de cada operação é conhecido
+        int i = (int)((x >> 4) % (unsigned int)a->nOwn);
+        if (a->ownPresent[i])
+        {
+            assert(!htmtInsertData(a->ht, a->own[i]));
+            assert(htmtRemoveString(a->ht, a->own[i]));
+            assert(!htmtExistString(a->ht, a->own[i]));
+        }
+        else
+        {
+            assert(!htmtRemoveString(a->ht, a->own[i]));
+            assert(htmtInsertData(a->ht, a->own[i]));
+            assert(htmtExistString(a->ht, a->own[i]));
+        }
+        a->ownPresent[i] = !a->ownPresent[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief tabela partilhada entre threads: 8 threads inserem, removem e pesquisam ao mesmo tempo chaves comuns
+ * e chaves próprias; no fim as chaves próprias estão no estado esperado e "totalItems" é igual ao número de
+ * chaves que ainda existem
+ */
+void testHashTableMT(void)
+{
+    enum { nThreads = 8, nShared = 512, nOwn = 256 };
+    char **shared = testKeys("s", nShared);
+    char **own = testKeys("p", nThreads * nOwn);
+    bool *ownPresent = (bool *)calloc(nThreads * nOwn, sizeof(bool));
+    assert(ownPresent);
+    HashTableMTCFG *ht = newHashTableMT(97, WYHash, fakeHashDestroy, testGetString);
+    pthread_t th[nThreads];
+    TestMTArg args[nThreads];
+    for (int t = 0; t < nThreads; t++)
+    {
+        args[t] = (TestMTArg){ht, shared, nShared, own + t * nOwn, nOwn, ownPresent + t * nOwn, (unsigned int)(t + 1)};
+        assert(pthread_create(&th[t], NULL, testMTWorker, &args[t]) == 0);
+    }
+    for (int t = 0; t < nThreads; t++)
+        pthread_join(th[t], NULL);
+
+    size_t existem = 0;
+    for (int i = 0; i < nShared; i++)
+        existem += htmtExistString(ht, shared[i]);
+    for (int i = 0; i < nThreads * nOwn; i++)
+    {
+        assert(htmtExistString(ht, own[i]) == ownPresent[i]);
+        existem += ownPresent[i];
+    }
+    assert(atomic_load(&ht->totalItems) == existem);
+    destroyHashTableMT(ht);
+    free(ownPresent);
+    testFreeKeys(shared, nShared);
+    testFreeKeys(own, nThreads * nOwn);
+    printf("testHashTableMT: ok\n");
+}
+
+/**
+ * @brief WYHash64Seed é o wyhash "final 4" original: os vetores de teste do wyhash (semente = índice) e o valor
+ * de verificação do SMHasher, que junta o hash das chaves {0, 1, ..., l - 1} de todos os comprimentos l de 0 a 255
+ * (semente 256 - l) e passa por todos os casos do ciclo de 48 bytes (48, 49, 64, 96, ...)
+ */
+void testWYHash(void)
+{
+    const char *v[] = {"", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+                       "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+                       "12345678901234567890123456789012345678901234567890123456789012345678901234567890"};
+    const unsigned long long esperado[] = {0x93228a4de0eec5a2ULL, 0xc5bac3db178713c4ULL, 0xa97f2f7b1d9b3314ULL,
+                                           0x786d1f1df3801df4ULL, 0xdca5a8138ad37c87ULL, 0xb9e734f117cfaf70ULL,
+                                           0x6cc5eab49a92d617ULL};
+    for (int i = 0; i < 7; i++)
+    {
+        assert(WYHash64Seed(v[i], (unsigned int)strlen(v[i]), (unsigned long long)i) == esperado[i]);
+    }
+
+    unsigned char key[256], hashes[8 * 256];
+    for (int l = 0; l < 256; l++)
+    {
+        key[l] = (unsigned char)l;
+        unsigned long long h = WYHash64Seed((const char *)key, (unsigned int)l, (unsigned long long)(256 - l));
+        memcpy(hashes + 8 * l, &h, 8);
+    }
+    unsigned long long h = WYHash64Seed((const char *)hashes, sizeof(hashes), 0);
+    // os 4 primeiros bytes do resultado (little-endian)
+    assert((unsigned int)h == 0x9DAE7DD3U);
+    printf("testWYHash: ok\n");
+}
+
+/**
+ * @brief hash por partes: para todas as funções, comprimentos de 0 a 300 (todos os casos dos blocos de 32 e 48
+ * bytes) e alguns maiores, partidos em pedaços de tamanhos irregulares (incluindo vazios), o resultado é igual ao
+ * da função de uma só vez; WY e STRIPE também com semente e com o resultado de 64 bits
+ */
+void testHashStream(void)
+{
+    static char key[5000];
+    srand(12345);
+    for (size_t i = 0; i < sizeof(key); i++)
+    {
+        key[i] = (char)(rand() & 0xFF);
+    }
+    const unsigned int grandes[] = {511, 512, 1000, 4096, 4999};
+    for (int f = 0; f < hashKnownAlgorithmsCount; f++)
+    {
+        for (int c = 0; c < 301 + 5; c++)
+        {
+            unsigned int length = c < 301 ? (unsigned int)c : grandes[c - 301];
+            unsigned int esperado = hashKnownAlgorithms[f].func(key, length);
+            unsigned long long seed = (unsigned long long)c * 0x9E3779B97F4A7C15ULL;
+            // 0: tudo de uma vez, 1: byte a byte, 2..: pedaços aleatórios até 100 bytes
+            for (int modo = 0; modo < 4; modo++)
+            {
+                HashKnownStream st, stSeed;
+                hashKnownStreamInit(&st, (HashKnownAlgorithmId)f);
+                hashKnownStreamInitSeed(&stSeed, (HashKnownAlgorithmId)f, seed);
+                unsigned int pos = 0;
+                while (pos < length || (modo >= 2 && pos == 0 && rand() % 2))
+                {
+                    unsigned int n = modo == 0 ? length : modo == 1 ? 1 : (unsigned int)(rand() % 101);
+                    if (n > length - pos)
+                        n = length - pos;
+                    hashKnownStreamUpdate(&st, key + pos, n);
+                    hashKnownStreamUpdate(&stSeed, key + pos, n);
+                    pos += n;
+                }
+                assert(hashKnownStreamFinal(&st) == esperado);
+                if (f == HKA_WY)
+                {
+                    assert(hashKnownStreamFinal64(&st) == WYHash64Seed(key, length, 0));
+                    assert(hashKnownStreamFinal64(&stSeed) == WYHash64Seed(key, length, seed));
+                }
+                else if (f == HKA_STRIPE)
+                {
+                    assert(hashKnownStreamFinal64(&st) == StripeHash64Seed(key, length, 0));
+                    assert(hashKnownStreamFinal64(&stSeed) == StripeHash64Seed(key, length, seed));
+                }
+            }
+        }
+    }
+    printf("testHashStream: ok\n");
+}
+
+int main(void)
+{
+    testResize();
+    testWYHash();
+    testHashStream();
+    testSwissTable();
+    testRobinHood();
+    testMphf();
+    testSnapshot();
+    testStatsTracking();
+    testTreeRehash();
+    testParallelBuild();
+    testBatch();
+    testBloom();
+    testTopK();
+    testSizing();
+    testPrimes();
+    testAutoHash();
+    testWordCount();
+    testHashTableMT();
+    printf("todos os testes passaram\n");
+    return 0;
+}
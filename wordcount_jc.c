@@ -0,0 +1,232 @@
+/**
+ * @file wordcount_jc.c
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief Implementação da contagem de palavras de ficheiros de texto mapeados com "mmap": a separação das palavras
+ * classifica 16 bytes de cada vez (SSE2, quando disponível) e a pesquisa usa a palavra no próprio ficheiro,
+ * só as palavras novas são copiadas.
+ * @version 0.1
+ * @date 2021-06-08
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <malloc.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "wordcount_jc.h"
+#include "hash_known_algorithms.h"
+
+/**
+ * @brief função para criar os dados de uma palavra nova: cópia terminada em '\0' (libertada com "free")
+ *
+ * @param key
+ * @param length
+ * @return void*
+ */
+void *wcNewWord(const void *key, unsigned int length)
+{
+    char *s = (char *)malloc((size_t)length + 1);
+    assert(s);
+    memcpy(s, key, length);
+    s[length] = '\0';
+    return s;
+}
+
+/**
+ * @brief função que devolve a palavra guardada nos dados
+ *
+ * @param data
+ * @return char*
+ */
+char *wcGetString(void *data)
+{
+    return (char *)data;
+}
+
+/**
+ * @brief função para criar uma tabela de contagem de palavras (WYHash, dados criados por wcNewWord),
+ * o número de ocorrências de cada palavra é "count" + 1
+ *
+ * @param m
+ * @return HashTableCFG*
+ */
+HashTableCFG *newWordCountTable(size_t m)
+{
+    return newHashTableHashKey(m, WYHash, free, wcGetString);
+}
+
+// uso interno, não exportar!!!!!
+bool wcIsWordByte(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c >= 0x80;
+}
+
+/**
+ * @brief função que devolve a máscara dos bytes de palavras dos WC_BLOCK bytes a partir de "p" (NOTA: é uma função interna)
+ *
+ * @param p
+ * @return unsigned int
+ */
+unsigned int wcWordMask(const char *p)
+{
+#if defined(__SSE2__)
+    __m128i x = _mm_loadu_si128((const __m128i *)p);
+    // "x" em [lo, lo + n] <=> (x - lo) sem sinal <= n
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+    __m128i digito = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    // o bit 0x20 junta as maiúsculas às minúsculas
+    __m128i l = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i letra = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(25)), l);
+    // os bytes >= 0x80 já têm o bit de sinal ligado
+    return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(digito, letra), x));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < WC_BLOCK; i++)
+    {
+        if (wcIsWordByte((unsigned char)p[i]))
+            mask |= 1U << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief função que devolve o primeiro byte a partir de "p" que é (word = true) ou não é (word = false)
+ * um byte de palavra, ou "end" (NOTA: é uma função interna)
+ *
+ * @param p
+ * @param end
+ * @param word
+ * @return const char*
+ */
+const char *wcFind(const char *p, const char *end, bool word)
+{
+    unsigned int inverte = word ? 0 : (1U << WC_BLOCK) - 1;
+    while (end - p >= WC_BLOCK)
+    {
+        unsigned int mask = wcWordMask(p) ^ inverte;
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += WC_BLOCK;
+    }
+    while (p < end && wcIsWordByte((unsigned char)*p) != word)
+        p++;
+    return p;
+}
+
+/**
+ * @brief função que devolve a próxima palavra de [p, end) sem a copiar
+ *
+ * @param p
+ * @param end
+ * @param length devolve o comprimento da palavra
+ * @return const char* início da palavra ou NULL se não houver mais palavras
+ */
+const char *wcNextToken(const char *p, const char *end, size_t *length)
+{
+    p = wcFind(p, end, true);
+    if (p == end)
+        return NULL;
+    (*length) = (size_t)(wcFind(p, end, false) - p);
+    return p;
+}
+
+/**
+ * @brief procedimento para contar as palavras de um bloco de texto na tabela (criada com newWordCountTable ou com
+ * dados criados da mesma forma); os totais são somados aos que "stats" já tem (os tempos não são alterados)
+ *
+ * @param ht
+ * @param buf
+ * @param size
+ * @param stats
+ */
+void wcIngestBuffer(HashTableCFG *ht, const char *buf, size_t size, WordCountStats *stats)
+{
+    assert(ht);
+    assert(stats);
+    const char *end = buf + size;
+    const char *p = buf;
+    size_t length;
+    while ((p = wcNextToken(p, end, &length)) != NULL)
+    {
+        // os comprimentos das chaves são "unsigned int", uma palavra maior é contada aos bocados
+        while (length > 0)
+        {
+            unsigned int l = length > UINT_MAX ? UINT_MAX : (unsigned int)length;
+            if (htCountKey(ht, p, l, wcNewWord))
+                stats->newTokens++;
+            stats->tokens++;
+            p += l;
+            length -= l;
+        }
+    }
+    stats->bytes += size;
+}
+
+// uso interno, não exportar!!!!!
+double wcNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief função para contar as palavras de um ficheiro: o ficheiro é mapeado só de leitura (leitura sequencial),
+ * percorrido com wcIngestBuffer e desmapeado no fim; "stats" fica com os totais e os débitos deste ficheiro
+ *
+ * @param ht
+ * @param path
+ * @param stats
+ * @return true
+ * @return false se não foi possível abrir ou mapear o ficheiro
+ */
+bool wcIngestFile(HashTableCFG *ht, const char *path, WordCountStats *stats)
+{
+    assert(ht);
+    assert(stats);
+    memset(stats, 0, sizeof(WordCountStats));
+    double t0 = wcNow();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size > 0)
+    {
+        void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // o mapeamento continua válido depois de fechar o descritor
+        close(fd);
+        if (base == MAP_FAILED)
+            return false;
+        madvise(base, size, MADV_SEQUENTIAL);
+        wcIngestBuffer(ht, (const char *)base, size, stats);
+        munmap(base, size);
+    }
+    else
+    {
+        close(fd);
+    }
+    stats->seconds = wcNow() - t0;
+    if (stats->seconds > 0)
+    {
+        stats->mbPerSec = (double)stats->bytes / stats->seconds / 1e6;
+        stats->tokensPerSec = (double)stats->tokens / stats->seconds;
+    }
+    return true;
+}
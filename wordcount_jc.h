@@ -0,0 +1,51 @@
+/**
+ * @file wordcount_jc.h
+ * @author João Pinto (pinjoa@gmail.com)
+ * @brief interface da contagem de palavras de ficheiros de texto com a hashtable: o ficheiro é mapeado com "mmap",
+ * as palavras são separadas diretamente sobre o ficheiro mapeado (16 bytes de cada vez com SSE2) e cada palavra
+ * é pesquisada no próprio ficheiro; só as palavras novas são copiadas para a tabela, as repetidas apenas
+ * incrementam o contador "count" do nodo.
+ * Uma palavra é uma sequência de letras e algarismos ASCII e de bytes >= 0x80 (os carateres UTF-8 acentuados
+ * ficam dentro das palavras); todos os outros bytes separam palavras. As palavras não são convertidas (maiúsculas
+ * e minúsculas são palavras diferentes).
+ * @version 0.1
+ * @date 2021-06-08
+ *
+ * @copyright Copyright (c) 2021, João Carlos Pinto
+ *
+ */
+
+#ifndef INC_14AED2HASH_WORDCOUNT_JC_H
+#define INC_14AED2HASH_WORDCOUNT_JC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hashtable_jc.h"
+
+/**
+ * @brief bytes classificados de cada vez na procura do início/fim das palavras (um registo SSE2)
+ */
+#define WC_BLOCK 16
+
+/**
+ * @brief resultado de uma contagem
+ */
+typedef struct wordcountstats WordCountStats;
+struct wordcountstats {
+    size_t bytes;                   /**< bytes de texto percorridos. */
+    unsigned long long tokens;      /**< palavras encontradas. */
+    unsigned long long newTokens;   /**< palavras inseridas na tabela (as restantes só incrementaram "count"). */
+    double seconds;                 /**< tempo total, incluindo mapear o ficheiro. */
+    double mbPerSec;                /**< MB (10^6 bytes) por segundo. */
+    double tokensPerSec;            /**< palavras por segundo. */
+};
+
+HashTableCFG *newWordCountTable(size_t m);
+void *wcNewWord(const void *key, unsigned int length);
+char *wcGetString(void *data);
+
+const char *wcNextToken(const char *p, const char *end, size_t *length);
+void wcIngestBuffer(HashTableCFG *ht, const char *buf, size_t size, WordCountStats *stats);
+bool wcIngestFile(HashTableCFG *ht, const char *path, WordCountStats *stats);
+
+#endif //INC_14AED2HASH_WORDCOUNT_JC_H